@@ -1,4 +1,4 @@
-#include "chip8.h"
+#include "chip.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -26,8 +26,9 @@ const uint8_t chip8_fontset[CHIP8_FONTSET_SIZE] = {
 
 // 初始化CHIP-8虚拟机
 void chip8_initialize(Chip8* chip8) {
-    // 初始化随机数种子
-    srand((unsigned int)time(NULL));
+    // 初始化随机数种子（实例独立，不影响全局rand()）
+    chip8_seed_rng(chip8, (uint32_t)time(NULL));
+    chip8->quirks = 0;
 
     // 重置所有状态
     chip8_reset(chip8);
@@ -59,6 +60,7 @@ void chip8_reset(Chip8* chip8) {
     // 重置定时器
     chip8->delay_timer = 0;
     chip8->sound_timer = 0;
+    chip8->sound_on = 0;
 
     // 清空按键状态
     memset(chip8->keys, 0, sizeof(chip8->keys));
@@ -117,6 +119,15 @@ int chip8_load_rom(Chip8* chip8, const char* filename) {
     return 0;
 }
 
+// 从内存缓冲区加载ROM（无文件IO、无日志输出，供批量/无界面运行使用）
+int chip8_load_rom_buffer(Chip8* chip8, const uint8_t* data, size_t size) {
+    if (!data || size > (size_t)(CHIP8_MEMORY_SIZE - 0x200)) {
+        return -1;
+    }
+    memcpy(&chip8->memory[0x200], data, size);
+    return 0;
+}
+
 // 执行一个完整的CHIP-8指令周期
 void chip8_emulate_cycle(Chip8* chip8) {
     // 取指 (fetch)
@@ -129,6 +140,18 @@ void chip8_emulate_cycle(Chip8* chip8) {
     // 注意：某些指令会在执行时更新PC，这里不需要额外更新
 }
 
+// 执行一帧：最多cycles条指令（遇到暂停即停止），然后更新一次定时器
+// 返回：实际执行的指令数
+int chip8_run_frame(Chip8* chip8, int cycles) {
+    int executed = 0;
+    while (executed < cycles && !chip8->halted) {
+        chip8_emulate_cycle(chip8);
+        executed++;
+    }
+    chip8_update_timers(chip8);
+    return executed;
+}
+
 // 获取当前PC指向的16位指令
 uint16_t chip8_fetch_opcode(const Chip8* chip8) {
     // CHIP-8是大端字节序
@@ -145,10 +168,6 @@ void chip8_decode_execute(Chip8* chip8, uint16_t opcode) {
     uint8_t nn    = (opcode & 0x00FF);        // 最低8位
     uint16_t nnn  = (opcode & 0x0FFF);        // 最低12位
 
-    // 指令计数器，用于调试
-    static uint32_t instruction_count = 0;
-    instruction_count++;
-
     // 根据操作码执行相应指令
     switch (op) {
         case 0x0:
@@ -237,14 +256,17 @@ void chip8_decode_execute(Chip8* chip8, uint16_t opcode) {
                 case 0x1:
                     // 8XY1 - Vx |= Vy
                     chip8->V[x] |= chip8->V[y];
+                    if (chip8->quirks & CHIP8_QUIRK_VF_RESET) chip8->V[0xF] = 0;
                     break;
                 case 0x2:
                     // 8XY2 - Vx &= Vy
                     chip8->V[x] &= chip8->V[y];
+                    if (chip8->quirks & CHIP8_QUIRK_VF_RESET) chip8->V[0xF] = 0;
                     break;
                 case 0x3:
                     // 8XY3 - Vx ^= Vy
                     chip8->V[x] ^= chip8->V[y];
+                    if (chip8->quirks & CHIP8_QUIRK_VF_RESET) chip8->V[0xF] = 0;
                     break;
                 case 0x4:
                     // 8XY4 - Vx += Vy (带进位)
@@ -261,6 +283,7 @@ void chip8_decode_execute(Chip8* chip8, uint16_t opcode) {
                     break;
                 case 0x6:
                     // 8XY6 - Vx >>= 1 (带进位)
+                    if (chip8->quirks & CHIP8_QUIRK_SHIFT_VY) chip8->V[x] = chip8->V[y];
                     chip8->V[0xF] = chip8->V[x] & 0x1;
                     chip8->V[x] >>= 1;
                     break;
@@ -271,6 +294,7 @@ void chip8_decode_execute(Chip8* chip8, uint16_t opcode) {
                     break;
                 case 0xE:
                     // 8XYE - Vx <<= 1 (带进位)
+                    if (chip8->quirks & CHIP8_QUIRK_SHIFT_VY) chip8->V[x] = chip8->V[y];
                     chip8->V[0xF] = (chip8->V[x] & 0x80) ? 1 : 0;
                     chip8->V[x] <<= 1;
                     break;
@@ -304,13 +328,13 @@ void chip8_decode_execute(Chip8* chip8, uint16_t opcode) {
             break;
 
         case 0xB:
-            // BNNN - 跳转到NNN + V0
-            chip8->PC = nnn + chip8->V[0];
+            // BNNN - 跳转到NNN + V0（JUMP_VX兼容模式下为 XNN + Vx）
+            chip8->PC = nnn + chip8->V[(chip8->quirks & CHIP8_QUIRK_JUMP_VX) ? x : 0];
             break;
 
         case 0xC:
             // CXNN - Vx = 随机数 & NN
-            chip8->V[x] = chip8_get_random_byte() & nn;
+            chip8->V[x] = chip8_get_random_byte(chip8) & nn;
             chip8->PC += 2;
             break;
 
@@ -393,12 +417,14 @@ void chip8_decode_execute(Chip8* chip8, uint16_t opcode) {
                     for (uint8_t i = 0; i <= x; i++) {
                         chip8->memory[chip8->I + i] = chip8->V[i];
                     }
+                    if (chip8->quirks & CHIP8_QUIRK_MEMORY_I) chip8->I += x + 1;
                     break;
                 case 0x65:
                     // FX65 - 从内存[I]开始的位置读取到V0到Vx
                     for (uint8_t i = 0; i <= x; i++) {
                         chip8->V[i] = chip8->memory[chip8->I + i];
                     }
+                    if (chip8->quirks & CHIP8_QUIRK_MEMORY_I) chip8->I += x + 1;
                     break;
                 default:
                     printf("无效指令: 0x%04X\n", opcode);
@@ -420,9 +446,11 @@ void chip8_update_timers(Chip8* chip8) {
     if (chip8->delay_timer > 0) {
         chip8->delay_timer--;
     }
+    // 在递减前锁存发声状态：ST=1的FX18也能响满一帧
+    // 声音由chip8_audio_sync根据sound_on的开关边沿驱动（--chip8交互运行时每帧定时器更新后调用，见main.c）
+    chip8->sound_on = chip8->sound_timer > 0;
     if (chip8->sound_timer > 0) {
         chip8->sound_timer--;
-        // 这里可以添加声音播放逻辑 (Day 2实现)
     }
 }
 
@@ -441,6 +469,22 @@ uint8_t chip8_is_key_pressed(const Chip8* chip8, uint8_t key) {
     return 0;
 }
 
+// 读取全部按键的16位掩码
+uint16_t chip8_get_key_mask(const Chip8* chip8) {
+    uint16_t mask = 0;
+    for (int i = 0; i < CHIP8_KEY_COUNT; i++) {
+        if (chip8->keys[i]) mask |= (uint16_t)(1u << i);
+    }
+    return mask;
+}
+
+// 按16位掩码设置全部按键状态
+void chip8_set_key_mask(Chip8* chip8, uint16_t mask) {
+    for (int i = 0; i < CHIP8_KEY_COUNT; i++) {
+        chip8->keys[i] = (uint8_t)((mask >> i) & 1);
+    }
+}
+
 // 绘制精灵到显示缓冲区
 uint8_t chip8_draw_sprite(Chip8* chip8, uint8_t x, uint8_t y, uint8_t height) {
     uint8_t collision = 0;
@@ -478,9 +522,30 @@ void chip8_clear_display(Chip8* chip8) {
     chip8->draw_flag = 1;
 }
 
-// 生成随机字节
-uint8_t chip8_get_random_byte(void) {
-    return (uint8_t)(rand() % 256);
+// 设置随机数种子（xorshift32状态不能为0）
+void chip8_seed_rng(Chip8* chip8, uint32_t seed) {
+    chip8->rng_state = seed ? seed : 0x9E3779B9u;
+}
+
+// 按位打包显示缓冲区
+// 每8个像素字节（取值0/1）读成一个64位整数，用一次乘法把8个最低位收集到最高字节
+// 注意：按小端字节序读取（x86/ARM）
+void chip8_pack_display(const Chip8* chip8, uint8_t* out) {
+    for (int i = 0; i < CHIP8_PACKED_DISPLAY_SIZE; i++) {
+        uint64_t v;
+        memcpy(&v, &chip8->display[i * 8], sizeof(v));
+        out[i] = (uint8_t)(((v & 0x0101010101010101ULL) * 0x8040201008040201ULL) >> 56);
+    }
+}
+
+// 生成随机字节（xorshift32，每个实例独立）
+uint8_t chip8_get_random_byte(Chip8* chip8) {
+    uint32_t v = chip8->rng_state;
+    v ^= v << 13;
+    v ^= v >> 17;
+    v ^= v << 5;
+    chip8->rng_state = v;
+    return (uint8_t)(v >> 24);
 }
 
 // 调试函数：打印寄存器状态
@@ -528,4 +593,48 @@ uint16_t chip8_get_rom_size(const Chip8* chip8) {
         }
     }
     return CHIP8_MEMORY_SIZE - 0x200;
+}
+
+// 计算显示缓冲区哈希（FNV-1a 64位）
+uint64_t chip8_hash_display(const Chip8* chip8) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < CHIP8_DISPLAY_WIDTH * CHIP8_DISPLAY_HEIGHT; i++) {
+        h ^= chip8->display[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// 按8字节分组混合的哈希（比逐字节FNV快，适合4KB内存+2KB显示的整机状态）
+static uint64_t hash_words(uint64_t h, const uint8_t* p, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, sizeof(w));
+        h = (h ^ w) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 29;
+    }
+    for (; i < n; i++) {
+        h = (h ^ p[i]) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// 计算整机状态哈希
+uint64_t chip8_state_hash(const Chip8* chip8) {
+    uint8_t regs[16 + 2 + 2 + 1 + 2 + 4 + 1];
+    memcpy(regs, chip8->V, 16);
+    regs[16] = (uint8_t)chip8->I;          regs[17] = (uint8_t)(chip8->I >> 8);
+    regs[18] = (uint8_t)chip8->PC;         regs[19] = (uint8_t)(chip8->PC >> 8);
+    regs[20] = chip8->SP;
+    regs[21] = chip8->delay_timer;         regs[22] = chip8->sound_timer;
+    regs[23] = (uint8_t)chip8->rng_state;  regs[24] = (uint8_t)(chip8->rng_state >> 8);
+    regs[25] = (uint8_t)(chip8->rng_state >> 16); regs[26] = (uint8_t)(chip8->rng_state >> 24);
+    regs[27] = chip8->halted;
+    uint64_t h = hash_words(0xcbf29ce484222325ULL, regs, sizeof(regs));
+    h = hash_words(h, (const uint8_t*)chip8->stack, sizeof(chip8->stack));
+    h = hash_words(h, chip8->memory, sizeof(chip8->memory));
+    h = hash_words(h, chip8->display, sizeof(chip8->display));
+    h ^= h >> 32;
+    return h;
 }
\ No newline at end of file
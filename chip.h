@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 // CHIP-8 硬件规格常量
 #define CHIP8_MEMORY_SIZE      4096  // 4KB内存
@@ -12,6 +13,12 @@
 #define CHIP8_KEY_COUNT        16    // 16个按键
 #define CHIP8_FONTSET_SIZE     80    // 字体数据大小 (16字符 x 5字节)
 
+// 兼容性行为（quirks）标志位，0表示当前默认行为
+#define CHIP8_QUIRK_VF_RESET   0x01  // 8XY1/8XY2/8XY3 执行后VF清零
+#define CHIP8_QUIRK_SHIFT_VY   0x02  // 8XY6/8XYE 以Vy为移位源
+#define CHIP8_QUIRK_MEMORY_I   0x04  // FX55/FX65 执行后 I += X + 1
+#define CHIP8_QUIRK_JUMP_VX    0x08  // BNNN 按 BXNN 解释：跳转到 XNN + Vx
+
 // CHIP-8 虚拟机结构体
 typedef struct {
     // CPU 寄存器
@@ -31,6 +38,7 @@ typedef struct {
     // 定时器系统
     uint8_t delay_timer;        // 延时定时器
     uint8_t sound_timer;        // 声音定时器
+    uint8_t sound_on;           // 最近一次定时器更新前sound_timer是否非0（蜂鸣器本帧是否发声）
 
     // 输入系统
     uint8_t keys[CHIP8_KEY_COUNT];  // 按键状态
@@ -39,6 +47,11 @@ typedef struct {
     uint16_t opcode;            // 当前指令
     uint8_t  halted;            // 虚拟机暂停标志
 
+    // 随机数状态（每个实例独立，便于并行运行与结果复现）
+    uint32_t rng_state;
+    // 兼容性行为配置（CHIP8_QUIRK_*），chip8_reset不会清除
+    uint8_t quirks;
+
     // 扩展功能状态 (Day 2实现)
     double speed_multiplier;    // 速度调节倍数
     char current_rom_path[256]; // 当前ROM路径
@@ -54,10 +67,13 @@ void chip8_initialize(Chip8* chip8);
 void chip8_load_fontset(Chip8* chip8);
 void chip8_reset(Chip8* chip8);
 int chip8_load_rom(Chip8* chip8, const char* filename);
+int chip8_load_rom_buffer(Chip8* chip8, const uint8_t* data, size_t size);
 
 // 指令执行
 void chip8_emulate_cycle(Chip8* chip8);
 void chip8_decode_execute(Chip8* chip8, uint16_t opcode);
+// 执行一帧：cycles条指令后更新一次定时器（60Hz帧），返回实际执行的指令数
+int chip8_run_frame(Chip8* chip8, int cycles);
 
 // 定时器和更新
 void chip8_update_timers(Chip8* chip8);
@@ -67,17 +83,29 @@ void chip8_print_registers(const Chip8* chip8);
 void chip8_print_display(const Chip8* chip8);
 void chip8_print_memory(const Chip8* chip8, uint16_t start, uint16_t end);
 uint16_t chip8_get_rom_size(const Chip8* chip8);
+// 计算显示缓冲区的64位哈希（FNV-1a），用于黄金帧比对
+uint64_t chip8_hash_display(const Chip8* chip8);
+// 计算完整机器状态哈希（寄存器、栈、定时器、RNG、内存与显示，不含按键与路径等外部状态）
+// 用于状态去重：哈希相同的两个快照后续行为视为一致
+uint64_t chip8_state_hash(const Chip8* chip8);
 
 // 键盘输入
 void chip8_set_key(Chip8* chip8, uint8_t key, uint8_t state);
 uint8_t chip8_is_key_pressed(const Chip8* chip8, uint8_t key);
+// 以16位掩码读写全部按键（位i对应按键i），用于输入录制与回放
+uint16_t chip8_get_key_mask(const Chip8* chip8);
+void chip8_set_key_mask(Chip8* chip8, uint16_t mask);
 
 // 显示相关
 uint8_t chip8_draw_sprite(Chip8* chip8, uint8_t x, uint8_t y, uint8_t height);
 void chip8_clear_display(Chip8* chip8);
+// 将显示缓冲区按位打包（每行8字节，像素x位于字节x/8的第7-(x%8)位）
+#define CHIP8_PACKED_DISPLAY_SIZE (CHIP8_DISPLAY_WIDTH * CHIP8_DISPLAY_HEIGHT / 8)
+void chip8_pack_display(const Chip8* chip8, uint8_t* out);
 
 // 工具函数
 uint16_t chip8_fetch_opcode(const Chip8* chip8);
-uint8_t chip8_get_random_byte(void);
+void chip8_seed_rng(Chip8* chip8, uint32_t seed);
+uint8_t chip8_get_random_byte(Chip8* chip8);
 
 #endif // CHIP8_H
\ No newline at end of file
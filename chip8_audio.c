@@ -0,0 +1,93 @@
+#include "chip8_audio.h"
+#include <string.h>
+
+// 音频回调（运行在SDL音频线程）
+// 功能点：
+// - 读取已到期的开关边沿，按边沿时刻分段合成方波
+// - 推进采样时钟play_pos，供模拟线程为新边沿打时间戳
+static void chip8_audio_callback(void* userdata, Uint8* stream, int len) {
+    Chip8Audio* a = (Chip8Audio*)userdata;
+    float* out = (float*)stream;
+    int count = len / (int)sizeof(float);
+    uint32_t pos = (uint32_t)SDL_AtomicGet(&a->play_pos);
+    int tail = SDL_AtomicGet(&a->tail);
+    int head = SDL_AtomicGet(&a->head);
+    SDL_MemoryBarrierAcquire();
+    const float step = a->tone_hz / (float)a->freq;
+
+    int i = 0;
+    while (i < count) {
+        // 本段结束位置：下一个边沿时刻或缓冲区末尾
+        int seg_end = count;
+        while (tail != head) {
+            const Chip8BeepEdge* e = &a->ring[tail & (CHIP8_AUDIO_RING_SIZE - 1)];
+            int32_t offset = (int32_t)(e->sample_time - (pos + (uint32_t)i));
+            if (offset > 0) {
+                if (offset < seg_end - i) seg_end = i + offset;
+                break;
+            }
+            a->playing = e->on;
+            tail++;
+        }
+        // 合成本段方波（关闭时输出静音）
+        for (; i < seg_end; i++) {
+            if (a->playing) {
+                out[i] = a->phase < 0.5f ? a->volume : -a->volume;
+                a->phase += step;
+                if (a->phase >= 1.0f) a->phase -= 1.0f;
+            } else {
+                out[i] = 0.0f;
+            }
+        }
+    }
+    SDL_AtomicSet(&a->tail, tail);
+    SDL_AtomicSet(&a->play_pos, (int)(pos + (uint32_t)count));
+}
+
+// 打开回调式音频设备
+// 功能点：
+// - 使用较小的设备缓冲区（256采样，约5.8ms），边沿延迟为一个缓冲区，低于一帧（16.7ms）
+// - 打开失败时静默继续（无声音）
+int chip8_audio_open(Chip8Audio* a, float tone_hz, float volume) {
+    memset(a, 0, sizeof(*a));
+    a->tone_hz = tone_hz;
+    a->volume = volume;
+    SDL_AudioSpec want, have;
+    SDL_zero(want);
+    want.freq = 44100;
+    want.format = AUDIO_F32SYS;
+    want.channels = 1;
+    want.samples = 256;
+    want.callback = chip8_audio_callback;
+    want.userdata = a;
+    a->dev = SDL_OpenAudioDevice(NULL, 0, &want, &have, 0);
+    if (a->dev == 0) {
+        SDL_Log("SDL_OpenAudioDevice failed: %s", SDL_GetError());
+        return -1;
+    }
+    a->freq = have.freq;
+    a->latency_samples = have.samples;
+    SDL_PauseAudioDevice(a->dev, 0);
+    return 0;
+}
+
+void chip8_audio_close(Chip8Audio* a) {
+    if (a->dev) SDL_CloseAudioDevice(a->dev);
+    a->dev = 0;
+}
+
+// 模拟线程写入开关边沿（无锁、无分配）
+// 缓冲区满时本次不写入，last_on保持不变，下一帧会重试
+void chip8_audio_sync(Chip8Audio* a, const Chip8* chip8) {
+    if (!a->dev) return;
+    int on = chip8->sound_on;
+    if (on == a->last_on) return;
+    int head = SDL_AtomicGet(&a->head);
+    if (head - SDL_AtomicGet(&a->tail) >= CHIP8_AUDIO_RING_SIZE) return;
+    Chip8BeepEdge* e = &a->ring[head & (CHIP8_AUDIO_RING_SIZE - 1)];
+    e->sample_time = (uint32_t)SDL_AtomicGet(&a->play_pos) + a->latency_samples;
+    e->on = (uint8_t)on;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&a->head, head + 1);
+    a->last_on = on;
+}
@@ -0,0 +1,47 @@
+#ifndef CHIP8_AUDIO_H
+#define CHIP8_AUDIO_H
+
+#include <stdint.h>
+#include <SDL.h>
+#include "chip.h"
+
+// 边沿环形缓冲区容量（必须为2的幂；每帧最多产生一次边沿，64足够覆盖一秒）
+#define CHIP8_AUDIO_RING_SIZE 64
+
+// 蜂鸣器开关边沿：在sample_time（音频设备采样时钟）时切换为on
+typedef struct {
+    uint32_t sample_time;
+    uint8_t on;
+} Chip8BeepEdge;
+
+// CHIP-8 蜂鸣器（回调式SDL音频 + 无锁单生产者/单消费者环形缓冲区）
+// 模拟线程只通过chip8_audio_sync写入开关边沿；音频回调读取边沿并合成方波
+// 整个过程不分配内存、不加锁
+typedef struct {
+    SDL_AudioDeviceID dev;
+    int freq;                    // 实际采样率
+    float tone_hz;               // 方波频率
+    float volume;                // 音量（0.0-1.0）
+    uint32_t latency_samples;    // 边沿相对当前播放位置的延迟（一个设备缓冲区）
+
+    Chip8BeepEdge ring[CHIP8_AUDIO_RING_SIZE];
+    SDL_atomic_t head;           // 写入位置（仅模拟线程修改）
+    SDL_atomic_t tail;           // 读取位置（仅音频回调修改）
+    SDL_atomic_t play_pos;       // 音频回调已输出的采样数（采样时钟）
+
+    // 音频回调私有状态
+    int playing;
+    float phase;
+
+    // 模拟线程私有状态
+    int last_on;
+} Chip8Audio;
+
+// 打开音频设备并启动回调，失败返回-1（此时chip8_audio_sync为空操作）
+int chip8_audio_open(Chip8Audio* a, float tone_hz, float volume);
+void chip8_audio_close(Chip8Audio* a);
+
+// 在chip8_update_timers之后调用：sound_on（定时器递减前锁存的发声状态）变化时写入一个边沿
+void chip8_audio_sync(Chip8Audio* a, const Chip8* chip8);
+
+#endif // CHIP8_AUDIO_H
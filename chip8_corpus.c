@@ -0,0 +1,322 @@
+#include "chip8_corpus.h"
+#include "chip8_journal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <SDL.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <dirent.h>
+#endif
+
+// 单个ROM的运行结果
+typedef enum {
+    CORPUS_PASS,     // 所有检查点哈希一致
+    CORPUS_FAIL,     // 某个检查点哈希不一致
+    CORPUS_MISSING,  // 没有黄金哈希文件
+    CORPUS_UPDATED,  // 已写入新的黄金哈希
+    CORPUS_ERROR     // ROM读取失败
+} CorpusStatus;
+
+typedef struct {
+    char path[512];            // ROM完整路径
+    size_t name_off;           // 文件名在path中的偏移（条目会被realloc/qsort移动，不能存指针）
+    CorpusStatus status;
+    int mismatch_frame;        // 第一个不一致的检查点帧号
+    uint64_t instructions;     // 实际执行的指令数
+    double ms;                 // 运行耗时（毫秒）
+} CorpusEntry;
+
+typedef struct {
+    CorpusEntry* entries;
+    int count;
+    SDL_atomic_t next;         // 下一个待领取的ROM序号
+    const Chip8CorpusConfig* cfg;
+    int interval;              // 实际使用的检查点间隔
+} CorpusJob;
+
+void chip8_corpus_default_config(Chip8CorpusConfig* cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->frames = 600;
+    cfg->cycles_per_frame = 10;
+    cfg->checkpoint_interval = 60;
+    cfg->threads = 0;
+    cfg->update_golden = 0;
+    cfg->seed = 0x12345678u;
+    cfg->run_frame = NULL;
+}
+
+// 判断文件是否为CHIP-8 ROM（按扩展名，不区分大小写）
+static int is_rom_name(const char* name) {
+    const char* dot = strrchr(name, '.');
+    if (!dot) return 0;
+    char ext[8] = {0};
+    for (int i = 0; i < 7 && dot[i + 1]; i++) ext[i] = (char)tolower((unsigned char)dot[i + 1]);
+    return strcmp(ext, "ch8") == 0 || strcmp(ext, "c8") == 0;
+}
+
+// 将ROM追加到列表（按需扩容）
+static int push_entry(CorpusJob* job, int* cap, const char* dir, const char* name) {
+    if (job->count == *cap) {
+        int ncap = *cap ? *cap * 2 : 32;
+        CorpusEntry* n = (CorpusEntry*)realloc(job->entries, sizeof(CorpusEntry) * ncap);
+        if (!n) return -1;
+        job->entries = n;
+        *cap = ncap;
+    }
+    CorpusEntry* e = &job->entries[job->count];
+    memset(e, 0, sizeof(*e));
+    size_t dl = strlen(dir);
+    snprintf(e->path, sizeof(e->path), "%s%s%s", dir,
+             (dl > 0 && (dir[dl - 1] == '/' || dir[dl - 1] == '\\')) ? "" : "/", name);
+    size_t pl = strlen(e->path), nl = strlen(name);
+    e->name_off = pl >= nl ? pl - nl : 0;
+    job->count++;
+    return 0;
+}
+
+static const char* entry_name(const CorpusEntry* e) {
+    return e->path + e->name_off;
+}
+
+static int compare_entries(const void* a, const void* b) {
+    return strcmp(entry_name((const CorpusEntry*)a), entry_name((const CorpusEntry*)b));
+}
+
+// 扫描目录，收集全部ROM（按文件名排序，保证报告顺序稳定）
+static int scan_dir(CorpusJob* job, const char* dir) {
+    int cap = 0;
+#ifdef _WIN32
+    char pattern[512];
+    snprintf(pattern, sizeof(pattern), "%s\\*", dir);
+    struct _finddata_t fd;
+    intptr_t h = _findfirst(pattern, &fd);
+    if (h == -1) return -1;
+    do {
+        if (!(fd.attrib & _A_SUBDIR) && is_rom_name(fd.name)) {
+            if (push_entry(job, &cap, dir, fd.name) != 0) break;
+        }
+    } while (_findnext(h, &fd) == 0);
+    _findclose(h);
+#else
+    DIR* d = opendir(dir);
+    if (!d) return -1;
+    struct dirent* de;
+    while ((de = readdir(d)) != NULL) {
+        if (de->d_name[0] != '.' && is_rom_name(de->d_name)) {
+            if (push_entry(job, &cap, dir, de->d_name) != 0) break;
+        }
+    }
+    closedir(d);
+#endif
+    if (job->count > 1) qsort(job->entries, job->count, sizeof(CorpusEntry), compare_entries);
+    return 0;
+}
+
+// 读取黄金哈希文件：每行 "帧号 哈希(16进制)"，#开头为注释
+static int read_golden(const char* path, int* frames, uint64_t* hashes, int max) {
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+    char line[128];
+    int n = 0;
+    while (n < max && fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') continue;
+        unsigned long long h = 0;
+        int fr = 0;
+#ifdef _MSC_VER
+        if (sscanf_s(line, "%d %llx", &fr, &h) == 2) {
+#else
+        if (sscanf(line, "%d %llx", &fr, &h) == 2) {
+#endif
+            frames[n] = fr;
+            hashes[n] = (uint64_t)h;
+            n++;
+        }
+    }
+    fclose(f);
+    return n;
+}
+
+static int write_golden(const char* path, const Chip8CorpusConfig* cfg, const int* frames, const uint64_t* hashes, int n) {
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+    fprintf(f, "# chip8 golden frames=%d cycles=%d seed=%u quirks=%u\n",
+            cfg->frames, cfg->cycles_per_frame, (unsigned)cfg->seed, (unsigned)cfg->quirks);
+    for (int i = 0; i < n; i++) {
+        fprintf(f, "%d %016llx\n", frames[i], (unsigned long long)hashes[i]);
+    }
+    fclose(f);
+    return 0;
+}
+
+// 读取整个ROM文件到缓冲区
+static long read_rom(const char* path, uint8_t* buf, long cap) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return -1;
+    long n = (long)fread(buf, 1, (size_t)cap, f);
+    int extra = fgetc(f);  // 仍有数据说明ROM超出可用内存
+    fclose(f);
+    return extra == EOF ? n : -1;
+}
+
+// 运行单个ROM并比对检查点
+static void run_entry(CorpusEntry* e, const Chip8CorpusConfig* cfg, int interval) {
+    uint8_t rom[CHIP8_MEMORY_SIZE - 0x200];
+    int frames[CHIP8_CORPUS_MAX_CHECKPOINTS];
+    uint64_t hashes[CHIP8_CORPUS_MAX_CHECKPOINTS];
+    int ncp = 0;
+    Chip8FrameFn run_frame = cfg->run_frame ? cfg->run_frame : chip8_run_frame;
+    Uint64 t0 = SDL_GetPerformanceCounter();
+
+    long size = read_rom(e->path, rom, (long)sizeof(rom));
+    Chip8 chip8;
+    memset(&chip8, 0, sizeof(chip8));
+    chip8_reset(&chip8);
+    chip8_seed_rng(&chip8, cfg->seed);
+    chip8.quirks = cfg->quirks;
+    if (size < 0 || chip8_load_rom_buffer(&chip8, rom, (size_t)size) != 0) {
+        e->status = CORPUS_ERROR;
+        return;
+    }
+
+    // 可选的脚本输入：同名.c8j日志
+    char journal_path[600];
+    snprintf(journal_path, sizeof(journal_path), "%s.c8j", e->path);
+    Chip8Journal journal;
+    Chip8JournalCursor cursor;
+    int scripted = chip8_journal_load(&journal, journal_path) == 0;
+    if (scripted && chip8_journal_prepare(&journal, &chip8, &cursor) != 0) {
+        chip8_journal_free(&journal);
+        e->status = CORPUS_ERROR;
+        return;
+    }
+
+    // 有日志时按录制时的每帧指令数运行（与--chip8-replay一致），否则使用配置值
+    int cycles = scripted ? journal.cycles_per_frame : cfg->cycles_per_frame;
+
+    // 无界面运行：记录每个检查点与最后一帧的显示哈希
+    for (int frame = 1; frame <= cfg->frames; frame++) {
+        if (scripted) chip8_journal_apply(&journal, &cursor, (uint32_t)(frame - 1), &chip8);
+        e->instructions += (uint64_t)run_frame(&chip8, cycles);
+        if ((frame % interval == 0 || frame == cfg->frames) && ncp < CHIP8_CORPUS_MAX_CHECKPOINTS) {
+            frames[ncp] = frame;
+            hashes[ncp] = chip8_hash_display(&chip8);
+            ncp++;
+        }
+    }
+    if (scripted) chip8_journal_free(&journal);
+    e->ms = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+    char golden_path[600];
+    snprintf(golden_path, sizeof(golden_path), "%s.golden", e->path);
+    if (cfg->update_golden) {
+        e->status = write_golden(golden_path, cfg, frames, hashes, ncp) == 0 ? CORPUS_UPDATED : CORPUS_ERROR;
+        return;
+    }
+    int gframes[CHIP8_CORPUS_MAX_CHECKPOINTS];
+    uint64_t ghashes[CHIP8_CORPUS_MAX_CHECKPOINTS];
+    int ng = read_golden(golden_path, gframes, ghashes, CHIP8_CORPUS_MAX_CHECKPOINTS);
+    if (ng < 0) {
+        e->status = CORPUS_MISSING;
+        return;
+    }
+    // 检查点数量或帧号不同也视为不一致（说明配置与黄金数据不匹配）
+    e->status = CORPUS_PASS;
+    for (int i = 0; i < ncp || i < ng; i++) {
+        if (i >= ncp || i >= ng || frames[i] != gframes[i] || hashes[i] != ghashes[i]) {
+            e->status = CORPUS_FAIL;
+            e->mismatch_frame = i < ncp ? frames[i] : gframes[i];
+            break;
+        }
+    }
+}
+
+// 工作线程：不断领取下一个ROM直到全部完成
+static int corpus_worker(void* data) {
+    CorpusJob* job = (CorpusJob*)data;
+    for (;;) {
+        int i = SDL_AtomicAdd(&job->next, 1);
+        if (i >= job->count) break;
+        run_entry(&job->entries[i], job->cfg, job->interval);
+    }
+    return 0;
+}
+
+static const char* status_name(CorpusStatus s) {
+    switch (s) {
+        case CORPUS_PASS: return "PASS";
+        case CORPUS_FAIL: return "FAIL";
+        case CORPUS_MISSING: return "MISSING";
+        case CORPUS_UPDATED: return "UPDATED";
+        default: return "ERROR";
+    }
+}
+
+// 并行运行测试集
+// 功能点：
+// - 扫描目录并按文件名排序
+// - 工作线程通过原子计数器领取ROM，各自使用独立的Chip8实例
+// - 汇总输出每个ROM的结果与整体吞吐量
+int chip8_corpus_run(const char* dir, const Chip8CorpusConfig* cfg, FILE* report) {
+    Chip8CorpusConfig defaults;
+    if (!cfg) {
+        chip8_corpus_default_config(&defaults);
+        cfg = &defaults;
+    }
+    if (!dir || cfg->frames <= 0 || cfg->cycles_per_frame <= 0) return -1;
+
+    CorpusJob job;
+    memset(&job, 0, sizeof(job));
+    job.cfg = cfg;
+    if (scan_dir(&job, dir) != 0) {
+        if (report) fprintf(report, "错误: 无法打开目录 %s\n", dir);
+        free(job.entries);
+        return -1;
+    }
+    // 检查点间隔：保证检查点数量不超过上限
+    job.interval = cfg->checkpoint_interval > 0 ? cfg->checkpoint_interval : cfg->frames;
+    int min_interval = (cfg->frames + CHIP8_CORPUS_MAX_CHECKPOINTS - 2) / (CHIP8_CORPUS_MAX_CHECKPOINTS - 1);
+    if (job.interval < min_interval) job.interval = min_interval;
+
+    int nthreads = cfg->threads > 0 ? cfg->threads : SDL_GetCPUCount();
+    if (nthreads > job.count) nthreads = job.count;
+    if (nthreads < 1) nthreads = 1;
+
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    SDL_Thread** threads = (SDL_Thread**)calloc((size_t)nthreads, sizeof(SDL_Thread*));
+    int started = 0;
+    for (int i = 1; threads && i < nthreads; i++) {
+        threads[i] = SDL_CreateThread(corpus_worker, "chip8-corpus", &job);
+        if (threads[i]) started++;
+    }
+    corpus_worker(&job);  // 当前线程也参与工作
+    for (int i = 1; threads && i < nthreads; i++) {
+        if (threads[i]) SDL_WaitThread(threads[i], NULL);
+    }
+    free(threads);
+    double wall_ms = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+    int failed = 0;
+    uint64_t total_instr = 0;
+    for (int i = 0; i < job.count; i++) {
+        CorpusEntry* e = &job.entries[i];
+        total_instr += e->instructions;
+        if (e->status == CORPUS_FAIL || e->status == CORPUS_MISSING || e->status == CORPUS_ERROR) failed++;
+        if (!report) continue;
+        double mips = e->ms > 0.0 ? (double)e->instructions / (e->ms * 1000.0) : 0.0;
+        if (e->status == CORPUS_FAIL) {
+            fprintf(report, "[%-7s] %-32s 第%d帧不一致  %8.2f ms  %8.2f MIPS\n",
+                    status_name(e->status), entry_name(e), e->mismatch_frame, e->ms, mips);
+        } else {
+            fprintf(report, "[%-7s] %-32s %8.2f ms  %8.2f MIPS\n", status_name(e->status), entry_name(e), e->ms, mips);
+        }
+    }
+    if (report) {
+        double mips = wall_ms > 0.0 ? (double)total_instr / (wall_ms * 1000.0) : 0.0;
+        fprintf(report, "共%d个ROM，失败%d个，%d线程，总耗时%.2f ms，总吞吐%.2f MIPS\n",
+                job.count, failed, started + 1, wall_ms, mips);
+    }
+    free(job.entries);
+    return failed;
+}
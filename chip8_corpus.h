@@ -0,0 +1,36 @@
+#ifndef CHIP8_CORPUS_H
+#define CHIP8_CORPUS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "chip.h"
+
+// 每个ROM最多记录的检查点数量
+#define CHIP8_CORPUS_MAX_CHECKPOINTS 64
+
+// 单帧执行函数：执行cycles条指令并更新定时器，返回实际执行的指令数
+// 默认使用chip8_run_frame；替换为其他实现即可验证其与参考解释器等价
+typedef int (*Chip8FrameFn)(Chip8* chip8, int cycles);
+
+// 一致性测试集运行配置
+typedef struct {
+    int frames;              // 每个ROM运行的帧数
+    int cycles_per_frame;    // 每帧执行的指令数
+    int checkpoint_interval; // 每隔多少帧记录一次显示哈希
+    int threads;             // 工作线程数（<=0表示使用全部CPU核心）
+    int update_golden;       // 1=写入/覆盖黄金哈希文件（.golden）
+    uint32_t seed;           // 随机数种子（保证CXNN结果可复现）
+    uint8_t quirks;          // 兼容性行为配置（CHIP8_QUIRK_*）
+    Chip8FrameFn run_frame;  // 单帧执行函数（NULL表示chip8_run_frame）
+} Chip8CorpusConfig;
+
+// 填充默认配置（600帧，每帧10条指令，每60帧一个检查点）
+void chip8_corpus_default_config(Chip8CorpusConfig* cfg);
+
+// 无界面并行运行目录下的全部ROM（.ch8/.c8），与同名.golden文件中的哈希比对
+// 若存在同名.c8j输入日志，则按日志注入按键（种子、quirks与每帧指令数也以日志为准）
+// 每个ROM的结果与吞吐量写入report（可为NULL）
+// 返回：失败的ROM数量；目录无法打开时返回-1
+int chip8_corpus_run(const char* dir, const Chip8CorpusConfig* cfg, FILE* report);
+
+#endif // CHIP8_CORPUS_H
@@ -0,0 +1,120 @@
+#include "chip8_env.h"
+#include <stdlib.h>
+#include <string.h>
+
+void chip8_env_default_config(Chip8EnvConfig* cfg, int num_envs) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->num_envs = num_envs;
+    cfg->frames_per_step = 4;
+    cfg->cycles_per_frame = 10;
+    cfg->obs_format = CHIP8_OBS_BITS;
+    cfg->reward_addr = 0x200;
+    cfg->max_frames = 0;
+}
+
+size_t chip8_env_obs_size(const Chip8EnvConfig* cfg) {
+    return cfg->obs_format == CHIP8_OBS_BITS ? CHIP8_PACKED_DISPLAY_SIZE
+                                             : CHIP8_DISPLAY_WIDTH * CHIP8_DISPLAY_HEIGHT;
+}
+
+// 写入单个环境的观测（只有画面变化时才重新打包）
+static void write_obs(Chip8Env* env, int i, int force) {
+    Chip8* c = &env->envs[i];
+    if (!c->draw_flag && !force) return;
+    uint8_t* dst = env->obs + env->obs_stride * (size_t)i;
+    if (env->cfg.obs_format == CHIP8_OBS_BITS) chip8_pack_display(c, dst);
+    else memcpy(dst, c->display, sizeof(c->display));
+    c->draw_flag = 0;
+}
+
+// 由全局种子、环境序号和局数派生独立种子
+static uint32_t derive_seed(uint32_t seed, int index, uint32_t episode) {
+    uint32_t h = seed ^ (0x9E3779B9u * (uint32_t)(index + 1)) ^ (0x85EBCA6Bu * episode);
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    return h;
+}
+
+// 重置单个环境：拷贝初始状态模板并重新播种
+static void reset_one(Chip8Env* env, int i) {
+    Chip8* c = &env->envs[i];
+    *c = env->initial;
+    chip8_seed_rng(c, derive_seed(env->seed, i, env->episodes[i]));
+    env->last_reward[i] = c->memory[env->cfg.reward_addr];
+    env->episode_frames[i] = 0;
+    write_obs(env, i, 1);
+}
+
+int chip8_env_init(Chip8Env* env, const Chip8EnvConfig* cfg, const uint8_t* rom, size_t rom_size, uint8_t* obs_buffer) {
+    memset(env, 0, sizeof(*env));
+    if (!cfg || cfg->num_envs <= 0 || !obs_buffer || cfg->reward_addr >= CHIP8_MEMORY_SIZE
+        || (cfg->use_done_addr && cfg->done_addr >= CHIP8_MEMORY_SIZE)) return -1;
+    env->cfg = *cfg;
+    env->obs = obs_buffer;
+    env->obs_stride = chip8_env_obs_size(cfg);
+    // 初始状态模板
+    chip8_reset(&env->initial);
+    env->initial.quirks = cfg->quirks;
+    if (chip8_load_rom_buffer(&env->initial, rom, rom_size) != 0) return -2;
+
+    size_t n = (size_t)cfg->num_envs;
+    env->envs = (Chip8*)malloc(sizeof(Chip8) * n);
+    env->last_reward = (uint8_t*)calloc(n, 1);
+    env->episode_frames = (uint32_t*)calloc(n, sizeof(uint32_t));
+    env->episodes = (uint32_t*)calloc(n, sizeof(uint32_t));
+    if (!env->envs || !env->last_reward || !env->episode_frames || !env->episodes) {
+        chip8_env_free(env);
+        return -3;
+    }
+    chip8_env_reset(env, 0);
+    return 0;
+}
+
+void chip8_env_free(Chip8Env* env) {
+    free(env->envs);
+    free(env->last_reward);
+    free(env->episode_frames);
+    free(env->episodes);
+    memset(env, 0, sizeof(*env));
+}
+
+void chip8_env_reset(Chip8Env* env, uint32_t seed) {
+    env->seed = seed;
+    for (int i = 0; i < env->cfg.num_envs; i++) {
+        env->episodes[i] = 0;
+        reset_one(env, i);
+    }
+}
+
+// 推进一步
+// 功能点：
+// - 注入动作掩码并执行frames_per_step帧
+// - 奖励为奖励字节的有符号差值（计分字节回绕时仍为小的正数）
+// - 停机、满足结束条件或达到最大帧数时标记done并自动重置
+void chip8_env_step(Chip8Env* env, const uint16_t* actions, float* rewards, uint8_t* dones) {
+    const Chip8EnvConfig* cfg = &env->cfg;
+    for (int i = 0; i < cfg->num_envs; i++) {
+        Chip8* c = &env->envs[i];
+        chip8_set_key_mask(c, actions ? actions[i] : 0);
+        for (int f = 0; f < cfg->frames_per_step && !c->halted; f++) {
+            chip8_run_frame(c, cfg->cycles_per_frame);
+        }
+        env->episode_frames[i] += (uint32_t)cfg->frames_per_step;
+
+        uint8_t r = c->memory[cfg->reward_addr];
+        if (rewards) rewards[i] = (float)(int8_t)(uint8_t)(r - env->last_reward[i]);
+        env->last_reward[i] = r;
+
+        int done = c->halted
+                || (cfg->use_done_addr && c->memory[cfg->done_addr] == cfg->done_value)
+                || (cfg->max_frames && env->episode_frames[i] >= cfg->max_frames);
+        if (dones) dones[i] = (uint8_t)done;
+        if (done) {
+            env->episodes[i]++;
+            reset_one(env, i);
+        } else {
+            write_obs(env, i, 0);
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef CHIP8_ENV_H
+#define CHIP8_ENV_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "chip.h"
+
+// 向量化的CHIP-8训练环境（类gym接口）
+// - N个Chip8实例同步推进，动作为每个环境的16位按键掩码
+// - 观测直接写入调用者提供的连续缓冲区（可位于共享内存，见shm_buffer.h），无需拷贝
+// - 奖励取自可配置的内存地址（两步之间该字节的有符号差值）
+// - 结束的环境自动重置，done标志告知调用者
+// 多核使用：把同一块观测缓冲区按环境切片，每个线程/进程各自创建一个Chip8Env
+
+// 观测格式
+typedef enum {
+    CHIP8_OBS_BITS,    // 按位打包，每个环境CHIP8_PACKED_DISPLAY_SIZE（256）字节
+    CHIP8_OBS_BYTES    // 每像素1字节（0/1），每个环境2048字节
+} Chip8ObsFormat;
+
+typedef struct {
+    int num_envs;             // 环境数量
+    int frames_per_step;      // 每步执行的帧数（跳帧）
+    int cycles_per_frame;     // 每帧执行的指令数
+    Chip8ObsFormat obs_format;
+    uint16_t reward_addr;     // 奖励字节所在内存地址
+    int use_done_addr;        // 1=当memory[done_addr]==done_value时结束
+    uint16_t done_addr;
+    uint8_t done_value;
+    uint32_t max_frames;      // 每局最大帧数（截断），0表示不限制
+    uint8_t quirks;           // 兼容性行为配置（CHIP8_QUIRK_*）
+} Chip8EnvConfig;
+
+typedef struct {
+    Chip8EnvConfig cfg;
+    Chip8* envs;              // num_envs个实例
+    Chip8 initial;            // ROM加载后的初始状态（重置时整体拷贝）
+    uint8_t* obs;             // 观测缓冲区（调用者所有）
+    size_t obs_stride;        // 每个环境的观测字节数
+    uint8_t* last_reward;     // 每个环境上一步的奖励字节
+    uint32_t* episode_frames; // 每个环境当前局已运行的帧数
+    uint32_t* episodes;       // 每个环境已完成的局数（用于派生种子）
+    uint32_t seed;
+} Chip8Env;
+
+// 填充默认配置（每步4帧，每帧10条指令，位打包观测）
+void chip8_env_default_config(Chip8EnvConfig* cfg, int num_envs);
+// 每个环境的观测字节数
+size_t chip8_env_obs_size(const Chip8EnvConfig* cfg);
+
+// 创建环境：obs_buffer至少num_envs * chip8_env_obs_size字节，成功返回0
+int chip8_env_init(Chip8Env* env, const Chip8EnvConfig* cfg, const uint8_t* rom, size_t rom_size, uint8_t* obs_buffer);
+void chip8_env_free(Chip8Env* env);
+
+// 以seed重置全部环境并写入初始观测（环境i使用由seed和i派生的种子）
+void chip8_env_reset(Chip8Env* env, uint32_t seed);
+// 推进一步：actions[i]为环境i的按键掩码；rewards/dones各num_envs个元素（可为NULL）
+void chip8_env_step(Chip8Env* env, const uint16_t* actions, float* rewards, uint8_t* dones);
+
+#endif // CHIP8_ENV_H
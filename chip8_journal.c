@@ -0,0 +1,152 @@
+#include "chip8_journal.h"
+#include "varint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JOURNAL_VERSION 1
+#define JOURNAL_HEADER_SIZE 20
+
+// 小端读写辅助函数
+static void put_u16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void put_u32(uint8_t* p, uint32_t v) { put_u16(p, (uint16_t)v); put_u16(p + 2, (uint16_t)(v >> 16)); }
+static uint16_t get_u16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t get_u32(const uint8_t* p) { return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16); }
+
+// 计算ROM程序区哈希（须在开始执行前调用，程序运行后内存会变化）
+uint32_t chip8_journal_rom_hash(const Chip8* chip8) {
+    uint32_t h = 2166136261u;
+    for (int i = 0x200; i < CHIP8_MEMORY_SIZE; i++) {
+        h ^= chip8->memory[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void chip8_journal_begin(Chip8Journal* j, const Chip8* chip8, int cycles_per_frame) {
+    memset(j, 0, sizeof(*j));
+    j->seed = chip8->rng_state;
+    j->quirks = chip8->quirks;
+    j->cycles_per_frame = (uint16_t)cycles_per_frame;
+    j->rom_hash = chip8_journal_rom_hash(chip8);
+}
+
+// 录制按键变化（仅在掩码变化时追加，录制路径按需扩容）
+int chip8_journal_record(Chip8Journal* j, uint32_t frame, uint16_t key_mask) {
+    if (key_mask == j->last_mask || frame < j->last_frame) return 0;
+    if (j->size + VARINT_MAX_BYTES + 2 > j->cap) {
+        size_t ncap = j->cap ? j->cap * 2 : 256;
+        uint8_t* n = (uint8_t*)realloc(j->data, ncap);
+        if (!n) return -1;
+        j->data = n;
+        j->cap = ncap;
+    }
+    j->size += (size_t)varint_write(j->data + j->size, frame - j->last_frame);
+    put_u16(j->data + j->size, key_mask);
+    j->size += 2;
+    j->last_frame = frame;
+    j->last_mask = key_mask;
+    return 0;
+}
+
+void chip8_journal_end(Chip8Journal* j, uint32_t total_frames) {
+    j->total_frames = total_frames;
+}
+
+void chip8_journal_free(Chip8Journal* j) {
+    free(j->data);
+    memset(j, 0, sizeof(*j));
+}
+
+int chip8_journal_save(const Chip8Journal* j, const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return -1;
+    uint8_t hdr[JOURNAL_HEADER_SIZE];
+    memcpy(hdr, "C8IJ", 4);
+    hdr[4] = JOURNAL_VERSION;
+    hdr[5] = j->quirks;
+    put_u16(hdr + 6, j->cycles_per_frame);
+    put_u32(hdr + 8, j->seed);
+    put_u32(hdr + 12, j->rom_hash);
+    put_u32(hdr + 16, j->total_frames);
+    int ok = fwrite(hdr, 1, sizeof(hdr), f) == sizeof(hdr)
+          && (j->size == 0 || fwrite(j->data, 1, j->size, f) == j->size);
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+int chip8_journal_load(Chip8Journal* j, const char* path) {
+    memset(j, 0, sizeof(*j));
+    FILE* f = fopen(path, "rb");
+    if (!f) return -1;
+    uint8_t hdr[JOURNAL_HEADER_SIZE];
+    if (fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr) || memcmp(hdr, "C8IJ", 4) != 0 || hdr[4] != JOURNAL_VERSION) {
+        fclose(f);
+        return -2;
+    }
+    j->quirks = hdr[5];
+    j->cycles_per_frame = get_u16(hdr + 6);
+    j->seed = get_u32(hdr + 8);
+    j->rom_hash = get_u32(hdr + 12);
+    j->total_frames = get_u32(hdr + 16);
+    // 读取剩余的事件流
+    fseek(f, 0, SEEK_END);
+    long end = ftell(f);
+    fseek(f, JOURNAL_HEADER_SIZE, SEEK_SET);
+    if (end > JOURNAL_HEADER_SIZE) {
+        j->cap = j->size = (size_t)(end - JOURNAL_HEADER_SIZE);
+        j->data = (uint8_t*)malloc(j->size);
+        if (!j->data || fread(j->data, 1, j->size, f) != j->size) {
+            fclose(f);
+            chip8_journal_free(j);
+            return -3;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+// 解码下一条按键变化事件
+static void cursor_advance(const Chip8Journal* j, Chip8JournalCursor* cur) {
+    uint32_t delta = 0;
+    const uint8_t* end = j->data + j->size;
+    int n = cur->pos < j->size ? varint_read(j->data + cur->pos, end, &delta) : 0;
+    if (n == 0 || cur->pos + (size_t)n + 2 > j->size) {
+        cur->has_next = 0;
+        return;
+    }
+    cur->pos += (size_t)n;
+    cur->next_frame += delta;
+    cur->next_mask = get_u16(j->data + cur->pos);
+    cur->pos += 2;
+    cur->has_next = 1;
+}
+
+int chip8_journal_prepare(const Chip8Journal* j, Chip8* chip8, Chip8JournalCursor* cur) {
+    memset(cur, 0, sizeof(*cur));
+    if (chip8_journal_rom_hash(chip8) != j->rom_hash) return -1;
+    chip8_seed_rng(chip8, j->seed);
+    chip8->quirks = j->quirks;
+    chip8_set_key_mask(chip8, 0);
+    cursor_advance(j, cur);
+    return 0;
+}
+
+void chip8_journal_apply(const Chip8Journal* j, Chip8JournalCursor* cur, uint32_t frame, Chip8* chip8) {
+    while (cur->has_next && cur->next_frame <= frame) {
+        chip8_set_key_mask(chip8, cur->next_mask);
+        cursor_advance(j, cur);
+    }
+}
+
+// 全速回放：只做按键注入与帧执行，不涉及渲染和计时
+uint64_t chip8_journal_replay(const Chip8Journal* j, Chip8* chip8) {
+    Chip8JournalCursor cur;
+    if (chip8_journal_prepare(j, chip8, &cur) != 0) return 0;
+    uint64_t executed = 0;
+    for (uint32_t frame = 0; frame < j->total_frames; frame++) {
+        chip8_journal_apply(j, &cur, frame, chip8);
+        executed += (uint64_t)chip8_run_frame(chip8, j->cycles_per_frame);
+    }
+    return executed;
+}
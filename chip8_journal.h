@@ -0,0 +1,60 @@
+#ifndef CHIP8_JOURNAL_H
+#define CHIP8_JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "chip.h"
+
+// CHIP-8 输入日志（确定性录制与回放）
+// 文件格式（小端）：
+//   "C8IJ" 魔数 | 版本(1字节) | quirks(1字节) | 每帧指令数(2字节)
+//   | RNG种子(4字节) | ROM哈希(4字节) | 总帧数(4字节) | 事件流
+// 事件流中每次按键变化为：varint(距上次变化的帧数) + 16位按键掩码，通常3字节
+typedef struct {
+    uint32_t seed;              // 开始录制时的RNG状态
+    uint8_t  quirks;            // 兼容性行为配置
+    uint16_t cycles_per_frame;  // 每帧执行的指令数
+    uint32_t rom_hash;          // ROM内容哈希（回放前校验）
+    uint32_t total_frames;      // 录制的总帧数
+
+    // 录制状态
+    uint32_t last_frame;        // 上一次按键变化的帧号
+    uint16_t last_mask;         // 上一次记录的按键掩码
+
+    // 编码后的事件流
+    uint8_t* data;
+    size_t size;
+    size_t cap;
+} Chip8Journal;
+
+// 回放游标：记录事件流读取位置与当前按键掩码
+typedef struct {
+    size_t pos;
+    uint32_t next_frame;        // 下一次按键变化的帧号
+    uint16_t next_mask;
+    int has_next;
+} Chip8JournalCursor;
+
+// 开始录制：从已加载ROM的chip8读取RNG种子、quirks与ROM哈希
+void chip8_journal_begin(Chip8Journal* j, const Chip8* chip8, int cycles_per_frame);
+// 记录第frame帧开始时的按键掩码（只有变化时才写入），失败返回-1
+int chip8_journal_record(Chip8Journal* j, uint32_t frame, uint16_t key_mask);
+// 结束录制，写入总帧数
+void chip8_journal_end(Chip8Journal* j, uint32_t total_frames);
+void chip8_journal_free(Chip8Journal* j);
+
+// 保存/读取日志文件，成功返回0
+int chip8_journal_save(const Chip8Journal* j, const char* path);
+int chip8_journal_load(Chip8Journal* j, const char* path);
+
+// 计算ROM内容哈希（FNV-1a 32位，0x200起的程序区）
+uint32_t chip8_journal_rom_hash(const Chip8* chip8);
+
+// 回放准备：设置chip8的种子与quirks，返回0；ROM哈希不匹配返回-1
+int chip8_journal_prepare(const Chip8Journal* j, Chip8* chip8, Chip8JournalCursor* cur);
+// 在第frame帧开始前应用该帧的按键变化（帧号须递增调用）
+void chip8_journal_apply(const Chip8Journal* j, Chip8JournalCursor* cur, uint32_t frame, Chip8* chip8);
+// 无界面全速回放全部帧，返回执行的指令数；ROM不匹配返回0
+uint64_t chip8_journal_replay(const Chip8Journal* j, Chip8* chip8);
+
+#endif // CHIP8_JOURNAL_H
@@ -0,0 +1,287 @@
+#include "chip8_search.h"
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+
+// 搜索树中一个节点的来源：父节点在上一层中的序号与本次决策的按键掩码
+typedef struct {
+    int parent;
+    uint16_t mask;
+} SearchLink;
+
+// 候选子状态（去重后）
+typedef struct {
+    int child;     // 在children数组中的序号
+    int score;     // 束搜索排序分数（越大越好）
+} SearchCandidate;
+
+// 一层扩展的共享数据（工作线程只写各自领取的子状态槽位）
+typedef struct {
+    const Chip8SearchConfig* cfg;
+    const uint16_t* masks;
+    int num_masks;
+    const Chip8* frontier;
+    int frontier_n;
+    Chip8* children;       // frontier_n * num_masks 个子状态
+    uint64_t* hashes;
+    SDL_atomic_t next;     // 下一个待扩展的父节点序号
+} SearchLevel;
+
+// 搜索线程池：每次搜索创建一次，逐层用信号量分发扩展任务
+typedef struct {
+    SearchLevel level;
+    SDL_sem* start;
+    SDL_sem* done;
+    SDL_atomic_t quit;
+    SDL_Thread* threads[64];
+    int num_workers;       // 含调用线程
+} SearchPool;
+
+// 已访问状态集合（开放寻址哈希表，键为状态哈希，0表示空槽）
+typedef struct {
+    uint64_t* keys;
+    size_t cap;
+    size_t count;
+} StateSet;
+
+void chip8_search_default_config(Chip8SearchConfig* cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->op = CHIP8_TARGET_EQ;
+    cfg->mode = CHIP8_SEARCH_BEAM;
+    cfg->beam_width = 256;
+    cfg->max_depth = 32;
+    cfg->frames_per_decision = 6;
+    cfg->cycles_per_frame = 10;
+    cfg->threads = 0;
+}
+
+// 插入哈希：1=新状态，0=已存在，-1=内存不足（负载超过一半时扩容）
+static int set_insert(StateSet* s, uint64_t h) {
+    if (h == 0) h = 1;
+    if ((s->count + 1) * 2 > s->cap) {
+        size_t ncap = s->cap ? s->cap * 2 : 4096;
+        uint64_t* nk = (uint64_t*)calloc(ncap, sizeof(uint64_t));
+        if (!nk) return -1;
+        for (size_t i = 0; i < s->cap; i++) {
+            if (!s->keys[i]) continue;
+            size_t j = (size_t)s->keys[i] & (ncap - 1);
+            while (nk[j]) j = (j + 1) & (ncap - 1);
+            nk[j] = s->keys[i];
+        }
+        free(s->keys);
+        s->keys = nk;
+        s->cap = ncap;
+    }
+    size_t j = (size_t)h & (s->cap - 1);
+    while (s->keys[j]) {
+        if (s->keys[j] == h) return 0;
+        j = (j + 1) & (s->cap - 1);
+    }
+    s->keys[j] = h;
+    s->count++;
+    return 1;
+}
+
+// 工作线程：领取父节点，为每个候选按键生成子状态快照并推进
+static int search_worker(void* data) {
+    SearchLevel* lv = (SearchLevel*)data;
+    for (;;) {
+        int i = SDL_AtomicAdd(&lv->next, 1);
+        if (i >= lv->frontier_n) break;
+        for (int m = 0; m < lv->num_masks; m++) {
+            int ci = i * lv->num_masks + m;
+            Chip8* child = &lv->children[ci];
+            *child = lv->frontier[i];
+            chip8_set_key_mask(child, lv->masks[m]);
+            for (int f = 0; f < lv->cfg->frames_per_decision && !child->halted; f++) {
+                chip8_run_frame(child, lv->cfg->cycles_per_frame);
+            }
+            lv->hashes[ci] = chip8_state_hash(child);
+        }
+    }
+    return 0;
+}
+
+static int target_reached(const Chip8SearchConfig* cfg, const Chip8* c) {
+    uint8_t v = c->memory[cfg->target_addr];
+    switch (cfg->op) {
+        case CHIP8_TARGET_GE: return v >= cfg->target_value;
+        case CHIP8_TARGET_LE: return v <= cfg->target_value;
+        default: return v == cfg->target_value;
+    }
+}
+
+// 束搜索分数：目标字节越接近目标越高
+static int target_score(const Chip8SearchConfig* cfg, const Chip8* c) {
+    int v = c->memory[cfg->target_addr];
+    switch (cfg->op) {
+        case CHIP8_TARGET_GE: return v;
+        case CHIP8_TARGET_LE: return -v;
+        default: return -abs(v - (int)cfg->target_value);
+    }
+}
+
+// 分数降序，分数相同按生成顺序（保证结果与线程数无关）
+static int compare_candidates(const void* a, const void* b) {
+    const SearchCandidate* x = (const SearchCandidate*)a;
+    const SearchCandidate* y = (const SearchCandidate*)b;
+    if (x->score != y->score) return y->score - x->score;
+    return x->child - y->child;
+}
+
+// 辅助线程：等待开始信号，扩展当前层，报告完成
+static int pool_thread(void* data) {
+    SearchPool* pool = (SearchPool*)data;
+    for (;;) {
+        SDL_SemWait(pool->start);
+        if (SDL_AtomicGet(&pool->quit)) break;
+        search_worker(&pool->level);
+        SDL_SemPost(pool->done);
+    }
+    return 0;
+}
+
+// 创建线程池（0号工作者由调用线程担任）；信号量创建失败时退化为单线程
+static void pool_create(SearchPool* pool, int nthreads) {
+    memset(pool, 0, sizeof(*pool));
+    if (nthreads < 1) nthreads = 1;
+    if (nthreads > 64) nthreads = 64;
+    pool->num_workers = 1;
+    if (nthreads == 1) return;
+    pool->start = SDL_CreateSemaphore(0);
+    pool->done = SDL_CreateSemaphore(0);
+    if (!pool->start || !pool->done) return;
+    for (int t = 1; t < nthreads; t++) {
+        pool->threads[t] = SDL_CreateThread(pool_thread, "chip8-search", pool);
+        if (!pool->threads[t]) break;
+        pool->num_workers = t + 1;
+    }
+}
+
+static void pool_destroy(SearchPool* pool) {
+    SDL_AtomicSet(&pool->quit, 1);
+    for (int t = 1; t < pool->num_workers; t++) SDL_SemPost(pool->start);
+    for (int t = 1; t < pool->num_workers; t++) SDL_WaitThread(pool->threads[t], NULL);
+    if (pool->start) SDL_DestroySemaphore(pool->start);
+    if (pool->done) SDL_DestroySemaphore(pool->done);
+}
+
+// 用线程池扩展一层（pool->level已填好）
+static void expand_level(SearchPool* pool) {
+    SDL_AtomicSet(&pool->level.next, 0);
+    for (int t = 1; t < pool->num_workers; t++) SDL_SemPost(pool->start);
+    search_worker(&pool->level);
+    for (int t = 1; t < pool->num_workers; t++) SDL_SemWait(pool->done);
+}
+
+// 输入搜索
+// 功能点：
+// - 每层对每个前沿状态按全部候选按键分叉（结构体拷贝即快照），并行推进frames_per_decision帧
+// - 以整机状态哈希去重，同一状态只会被扩展一次
+// - BFS按生成顺序保留，束搜索按目标字节接近程度保留beam_width个
+// - 找到目标后沿父节点链回溯出按键序列
+int chip8_search_run(const Chip8* start, const Chip8SearchConfig* cfg, Chip8SearchResult* result) {
+    static const uint16_t default_masks[17] = {
+        0, 1u << 0, 1u << 1, 1u << 2, 1u << 3, 1u << 4, 1u << 5, 1u << 6, 1u << 7,
+        1u << 8, 1u << 9, 1u << 10, 1u << 11, 1u << 12, 1u << 13, 1u << 14, 1u << 15
+    };
+    if (!start || !cfg || !result || cfg->beam_width <= 0 || cfg->target_addr >= CHIP8_MEMORY_SIZE) return -1;
+    memset(result, 0, sizeof(*result));
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    const uint16_t* masks = cfg->masks ? cfg->masks : default_masks;
+    int nm = cfg->masks ? cfg->num_masks : 17;
+    int max_depth = cfg->max_depth < CHIP8_SEARCH_MAX_DEPTH ? cfg->max_depth : CHIP8_SEARCH_MAX_DEPTH;
+    int width = cfg->beam_width;
+    int nthreads = cfg->threads > 0 ? cfg->threads : SDL_GetCPUCount();
+    if (nm <= 0) return -1;
+
+    if (target_reached(cfg, start)) {
+        result->found = 1;
+        return 0;
+    }
+
+    Chip8* frontier = (Chip8*)malloc(sizeof(Chip8) * (size_t)width);
+    Chip8* next_frontier = (Chip8*)malloc(sizeof(Chip8) * (size_t)width);
+    Chip8* children = (Chip8*)malloc(sizeof(Chip8) * (size_t)width * nm);
+    uint64_t* hashes = (uint64_t*)malloc(sizeof(uint64_t) * (size_t)width * nm);
+    SearchCandidate* cands = (SearchCandidate*)malloc(sizeof(SearchCandidate) * (size_t)width * nm);
+    SearchLink* links = (SearchLink*)malloc(sizeof(SearchLink) * (size_t)width * (max_depth + 1));
+    StateSet visited = { NULL, 0, 0 };
+    SearchPool pool;
+    pool_create(&pool, nthreads);
+    pool.level.cfg = cfg;
+    pool.level.masks = masks;
+    pool.level.num_masks = nm;
+    pool.level.children = children;
+    pool.level.hashes = hashes;
+    int rc = 0;
+    if (!frontier || !next_frontier || !children || !hashes || !cands || !links
+        || set_insert(&visited, chip8_state_hash(start)) < 0) {
+        rc = -2;
+        goto done;
+    }
+
+    frontier[0] = *start;
+    int frontier_n = 1;
+    for (int depth = 1; depth <= max_depth && frontier_n > 0 && !result->found; depth++) {
+        pool.level.frontier = frontier;
+        pool.level.frontier_n = frontier_n;
+        expand_level(&pool);
+
+        // 单线程合并：去重、检查目标、收集候选
+        int nc = 0;
+        int total = frontier_n * nm;
+        result->expanded += (uint64_t)total;
+        for (int ci = 0; ci < total; ci++) {
+            if (children[ci].halted) continue;
+            int ins = set_insert(&visited, hashes[ci]);
+            if (ins < 0) { rc = -2; goto done; }
+            if (ins == 0) { result->duplicates++; continue; }
+            if (target_reached(cfg, &children[ci])) {
+                // 回溯输入序列：links[d * width + k] 为第d层第k个节点的来源
+                result->found = 1;
+                result->depth = depth;
+                result->inputs[depth - 1] = masks[ci % nm];
+                int k = ci / nm;
+                for (int d = depth - 1; d >= 1; d--) {
+                    SearchLink l = links[d * width + k];
+                    result->inputs[d - 1] = l.mask;
+                    k = l.parent;
+                }
+                break;
+            }
+            cands[nc].child = ci;
+            cands[nc].score = cfg->mode == CHIP8_SEARCH_BEAM ? target_score(cfg, &children[ci]) : 0;
+            nc++;
+        }
+        if (result->found) break;
+
+        // 选择下一层前沿
+        if (cfg->mode == CHIP8_SEARCH_BEAM && nc > width) {
+            qsort(cands, (size_t)nc, sizeof(SearchCandidate), compare_candidates);
+        }
+        if (nc > width) nc = width;
+        for (int k = 0; k < nc; k++) {
+            int ci = cands[k].child;
+            next_frontier[k] = children[ci];
+            links[depth * width + k].parent = ci / nm;
+            links[depth * width + k].mask = masks[ci % nm];
+        }
+        Chip8* tmp = frontier;
+        frontier = next_frontier;
+        next_frontier = tmp;
+        frontier_n = nc;
+    }
+
+done:
+    pool_destroy(&pool);
+    result->ms = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    free(frontier);
+    free(next_frontier);
+    free(children);
+    free(hashes);
+    free(cands);
+    free(links);
+    free(visited.keys);
+    return rc;
+}
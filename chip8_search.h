@@ -0,0 +1,52 @@
+#ifndef CHIP8_SEARCH_H
+#define CHIP8_SEARCH_H
+
+#include <stdint.h>
+#include "chip.h"
+
+// 最大决策深度（输入序列长度）
+#define CHIP8_SEARCH_MAX_DEPTH 256
+
+// 目标条件：memory[target_addr] 与 target_value 的比较方式
+typedef enum {
+    CHIP8_TARGET_EQ,   // 等于
+    CHIP8_TARGET_GE,   // 大于等于（例如分数达到某值）
+    CHIP8_TARGET_LE    // 小于等于
+} Chip8TargetOp;
+
+// 搜索方式
+typedef enum {
+    CHIP8_SEARCH_BFS,  // 广度优先：每层保留全部新状态（最多beam_width个）
+    CHIP8_SEARCH_BEAM  // 束搜索：每层按目标字节接近程度保留最好的beam_width个
+} Chip8SearchMode;
+
+typedef struct {
+    uint16_t target_addr;
+    uint8_t target_value;
+    Chip8TargetOp op;
+    Chip8SearchMode mode;
+    int beam_width;            // 每层最多保留的状态数
+    int max_depth;             // 最大决策次数（不超过CHIP8_SEARCH_MAX_DEPTH）
+    int frames_per_decision;   // 两次决策之间运行的帧数
+    int cycles_per_frame;      // 每帧执行的指令数
+    const uint16_t* masks;     // 候选按键掩码（NULL表示“无按键”+16个单键）
+    int num_masks;
+    int threads;               // 工作线程数（<=0表示使用全部CPU核心）
+} Chip8SearchConfig;
+
+typedef struct {
+    int found;                 // 是否找到满足目标的输入序列
+    int depth;                 // 序列长度（决策次数）
+    uint16_t inputs[CHIP8_SEARCH_MAX_DEPTH];  // 每次决策的按键掩码
+    uint64_t expanded;         // 生成的子状态数
+    uint64_t duplicates;       // 因状态哈希重复而丢弃的子状态数
+    double ms;                 // 搜索耗时
+} Chip8SearchResult;
+
+void chip8_search_default_config(Chip8SearchConfig* cfg);
+
+// 从start状态（快照）出发搜索输入序列，不修改start
+// 返回：0=完成（是否找到见result->found），负数=参数或内存错误
+int chip8_search_run(const Chip8* start, const Chip8SearchConfig* cfg, Chip8SearchResult* result);
+
+#endif // CHIP8_SEARCH_H
@@ -1,10 +1,51 @@
 #include "keymap.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 
-static SDL_Keycode mapping[ACTION_COUNT];
+static SDL_Keycode mapping[ACTION_COUNT][KEYMAP_MAX_BINDINGS];
+static SDL_Keycode chip8_mapping[CHIP8_KEY_COUNT];
+static uint8_t button_action[SDL_CONTROLLER_BUTTON_MAX];
+static int das = KEYMAP_DEFAULT_DAS;
+static int arr = KEYMAP_DEFAULT_ARR;
 static int configuring_index = -1;
 
+// 以扫描码为下标的查找表：俄罗斯方块动作层 + CHIP-8小键盘层（按键值+1，0为未映射）
+typedef struct {
+    uint8_t action;
+    uint8_t chip8;
+} KeymapEntry;
+static KeymapEntry table[SDL_NUM_SCANCODES];
+
+// 配置文件中的动作名称（下标为TetrisAction）
+static const char* const action_names[ACTION_COUNT] = {
+    "", "MOVE_LEFT", "MOVE_RIGHT", "ROTATE", "SOFT_DROP", "HARD_DROP", "SPEED_UP", "SPEED_DOWN"
+};
+
+static int scancode_of(SDL_Keycode key) {
+    if (key == 0) return SDL_SCANCODE_UNKNOWN;
+    int sc = (int)SDL_GetScancodeFromKey(key);
+    return sc > SDL_SCANCODE_UNKNOWN && sc < SDL_NUM_SCANCODES ? sc : SDL_SCANCODE_UNKNOWN;
+}
+
+// 重建查找表
+// 功能点：
+// - 按当前键盘布局把全部绑定换算为扫描码
+// - 同一扫描码绑定了多个动作时，动作编号小的优先（与原线性查找一致）
+void keymap_rebuild(void) {
+    memset(table, 0, sizeof(table));
+    for (int a = 1; a < ACTION_COUNT; ++a) {
+        for (int i = 0; i < KEYMAP_MAX_BINDINGS; ++i) {
+            int sc = scancode_of(mapping[a][i]);
+            if (sc != SDL_SCANCODE_UNKNOWN && table[sc].action == ACTION_NONE) table[sc].action = (uint8_t)a;
+        }
+    }
+    for (int k = 0; k < CHIP8_KEY_COUNT; ++k) {
+        int sc = scancode_of(chip8_mapping[k]);
+        if (sc != SDL_SCANCODE_UNKNOWN && table[sc].chip8 == 0) table[sc].chip8 = (uint8_t)(k + 1);
+    }
+}
+
 // 初始化按键映射系统
 void keymap_init(void) {
     keymap_set_default();  // 设置默认映射
@@ -15,25 +56,46 @@ void keymap_init(void) {
 // - 使用方向键控制基本移动和旋转
 // - 空格键用于硬降
 // - +/-键用于速度调节
+// - 手柄：方向键移动/软降，A旋转，B硬降
+// - CHIP-8小键盘使用COSMAC VIP布局
+// - 自动重复恢复默认DAS/ARR
 void keymap_set_default(void) {
     // 默认映射：方向键 + 空格/上键
-    mapping[ACTION_MOVE_LEFT] = SDLK_LEFT;
-    mapping[ACTION_MOVE_RIGHT] = SDLK_RIGHT;
-    mapping[ACTION_ROTATE] = SDLK_UP;
-    mapping[ACTION_SOFT_DROP] = SDLK_DOWN;
-    mapping[ACTION_HARD_DROP] = SDLK_SPACE;
-    mapping[ACTION_SPEED_UP] = SDLK_EQUALS; 
-    mapping[ACTION_SPEED_DOWN] = SDLK_MINUS; 
+    memset(mapping, 0, sizeof(mapping));
+    mapping[ACTION_MOVE_LEFT][0] = SDLK_LEFT;
+    mapping[ACTION_MOVE_RIGHT][0] = SDLK_RIGHT;
+    mapping[ACTION_ROTATE][0] = SDLK_UP;
+    mapping[ACTION_SOFT_DROP][0] = SDLK_DOWN;
+    mapping[ACTION_HARD_DROP][0] = SDLK_SPACE;
+    mapping[ACTION_SPEED_UP][0] = SDLK_EQUALS; 
+    mapping[ACTION_SPEED_DOWN][0] = SDLK_MINUS; 
+    memset(button_action, 0, sizeof(button_action));
+    button_action[SDL_CONTROLLER_BUTTON_DPAD_LEFT] = ACTION_MOVE_LEFT;
+    button_action[SDL_CONTROLLER_BUTTON_DPAD_RIGHT] = ACTION_MOVE_RIGHT;
+    button_action[SDL_CONTROLLER_BUTTON_DPAD_DOWN] = ACTION_SOFT_DROP;
+    button_action[SDL_CONTROLLER_BUTTON_A] = ACTION_ROTATE;
+    button_action[SDL_CONTROLLER_BUTTON_B] = ACTION_HARD_DROP;
+    // COSMAC VIP小键盘：1 2 3 C / 4 5 6 D / 7 8 9 E / A 0 B F
+    static const char layout[CHIP8_KEY_COUNT + 1] = "x123qweasdzc4rfv";
+    for (int k = 0; k < CHIP8_KEY_COUNT; ++k) chip8_mapping[k] = (SDL_Keycode)layout[k];
+    das = KEYMAP_DEFAULT_DAS;
+    arr = KEYMAP_DEFAULT_ARR;
+    keymap_rebuild();
 }
 
 // 从文件加载按键映射配置
-
+// 功能点：
+// - NAME=code：动作在文件中第一次出现时替换原有绑定，之后的同名行追加绑定（单绑定的旧文件照常读取）
+// - PAD_NAME=button：手柄按钮绑定，文件中出现任一PAD_行时先清空手柄映射
+// - CHIP8_X=code：CHIP-8小键盘按键X（0-F）的绑定
 int keymap_load(const char* path) {
     if (!path) path = "key_config.txt";
     FILE* f = fopen(path, "r");
     if (!f) return -1;  
 
     char line[128];
+    int seen[ACTION_COUNT] = {0};
+    int pad_seen = 0;
     // 逐行读取并解析配置
     while (fgets(line, sizeof(line), f)) {
         char keyname[64];
@@ -44,17 +106,37 @@ int keymap_load(const char* path) {
 #else
         if (sscanf(line, "%63[^=]=%d", keyname, &val) == 2) {
 #endif
+            // 自动重复设置（超出范围的值忽略）
+            if (strcmp(keyname, "DAS") == 0) { keymap_set_repeat(val, arr); continue; }
+            if (strcmp(keyname, "ARR") == 0) { keymap_set_repeat(das, val); continue; }
+            if (strncmp(keyname, "CHIP8_", 6) == 0) {
+                char* end = NULL;
+                long k = strtol(keyname + 6, &end, 16);
+                if (end != keyname + 6 && *end == '\0') keymap_set_chip8_binding((int)k, (SDL_Keycode)val);
+                continue;
+            }
+            int pad = strncmp(keyname, "PAD_", 4) == 0;
+            const char* name = pad ? keyname + 4 : keyname;
             // 根据动作名称设置映射
-            if (strcmp(keyname, "MOVE_LEFT") == 0) mapping[ACTION_MOVE_LEFT] = (SDL_Keycode)val;
-            else if (strcmp(keyname, "MOVE_RIGHT") == 0) mapping[ACTION_MOVE_RIGHT] = (SDL_Keycode)val;
-            else if (strcmp(keyname, "ROTATE") == 0) mapping[ACTION_ROTATE] = (SDL_Keycode)val;
-            else if (strcmp(keyname, "SOFT_DROP") == 0) mapping[ACTION_SOFT_DROP] = (SDL_Keycode)val;
-            else if (strcmp(keyname, "HARD_DROP") == 0) mapping[ACTION_HARD_DROP] = (SDL_Keycode)val;
-            else if (strcmp(keyname, "SPEED_UP") == 0) mapping[ACTION_SPEED_UP] = (SDL_Keycode)val;
-            else if (strcmp(keyname, "SPEED_DOWN") == 0) mapping[ACTION_SPEED_DOWN] = (SDL_Keycode)val;
+            for (int a = 1; a < ACTION_COUNT; ++a) {
+                if (strcmp(name, action_names[a]) != 0) continue;
+                if (pad) {
+                    if (!pad_seen) memset(button_action, 0, sizeof(button_action));
+                    pad_seen = 1;
+                    keymap_set_button(val, (TetrisAction)a);
+                } else if (!seen[a]) {
+                    seen[a] = 1;
+                    memset(mapping[a], 0, sizeof(mapping[a]));
+                    mapping[a][0] = (SDL_Keycode)val;
+                } else {
+                    keymap_add_binding((TetrisAction)a, (SDL_Keycode)val);
+                }
+                break;
+            }
         }
     }
     fclose(f);
+    keymap_rebuild();
     return 0;
 }
 
@@ -64,14 +146,21 @@ int keymap_save(const char* path) {
     FILE* f = fopen(path, "w");
     if (!f) return -1;  
 
-    // 写入所有动作的按键映射
-    fprintf(f, "MOVE_LEFT=%d\n", (int)mapping[ACTION_MOVE_LEFT]);
-    fprintf(f, "MOVE_RIGHT=%d\n", (int)mapping[ACTION_MOVE_RIGHT]);
-    fprintf(f, "ROTATE=%d\n", (int)mapping[ACTION_ROTATE]);
-    fprintf(f, "SOFT_DROP=%d\n", (int)mapping[ACTION_SOFT_DROP]);
-    fprintf(f, "HARD_DROP=%d\n", (int)mapping[ACTION_HARD_DROP]);
-    fprintf(f, "SPEED_UP=%d\n", (int)mapping[ACTION_SPEED_UP]);
-    fprintf(f, "SPEED_DOWN=%d\n", (int)mapping[ACTION_SPEED_DOWN]);
+    // 写入所有动作的按键映射（每个绑定一行，未绑定的动作写0）
+    for (int a = 1; a < ACTION_COUNT; ++a) {
+        fprintf(f, "%s=%d\n", action_names[a], (int)mapping[a][0]);
+        for (int i = 1; i < KEYMAP_MAX_BINDINGS && mapping[a][i]; ++i) {
+            fprintf(f, "%s=%d\n", action_names[a], (int)mapping[a][i]);
+        }
+    }
+    for (int b = 0; b < SDL_CONTROLLER_BUTTON_MAX; ++b) {
+        if (button_action[b]) fprintf(f, "PAD_%s=%d\n", action_names[button_action[b]], b);
+    }
+    for (int k = 0; k < CHIP8_KEY_COUNT; ++k) {
+        fprintf(f, "CHIP8_%X=%d\n", k, (int)chip8_mapping[k]);
+    }
+    fprintf(f, "DAS=%d\n", das);
+    fprintf(f, "ARR=%d\n", arr);
 
     fclose(f);
     return 0;
@@ -79,23 +168,91 @@ int keymap_save(const char* path) {
 
 // 根据SDL按键码获取对应的游戏动作
 TetrisAction keymap_get_action(SDL_Keycode key) {
-    
-    for (int a = 1; a < ACTION_COUNT; ++a) {
-        if (mapping[a] == key) return (TetrisAction)a;
-    }
-    return ACTION_NONE;  
+    return (TetrisAction)table[scancode_of(key)].action;
+}
+
+TetrisAction keymap_lookup(SDL_Scancode sc) {
+    if ((int)sc <= SDL_SCANCODE_UNKNOWN || (int)sc >= SDL_NUM_SCANCODES) return ACTION_NONE;
+    return (TetrisAction)table[sc].action;
+}
+
+TetrisAction keymap_lookup_button(int button) {
+    if (button < 0 || button >= SDL_CONTROLLER_BUTTON_MAX) return ACTION_NONE;
+    return (TetrisAction)button_action[button];
 }
 
 // 获取指定动作当前绑定的SDL按键码
 SDL_Keycode keymap_get_binding(TetrisAction action) {
     if (action <= ACTION_NONE || action >= ACTION_COUNT) return (SDL_Keycode)0;
-    return mapping[action];
+    return mapping[action][0];
+}
+
+int keymap_get_bindings(TetrisAction action, SDL_Keycode* out, int max) {
+    if (action <= ACTION_NONE || action >= ACTION_COUNT) return 0;
+    int n = 0;
+    for (int i = 0; i < KEYMAP_MAX_BINDINGS && mapping[action][i] && n < max; ++i) out[n++] = mapping[action][i];
+    return n;
 }
 
 // 为指定动作设置新的按键绑定
 int keymap_set_binding(TetrisAction action, SDL_Keycode key) {
     if (action <= ACTION_NONE || action >= ACTION_COUNT) return -1;  // 无效动作
-    mapping[action] = key;
+    memset(mapping[action], 0, sizeof(mapping[action]));
+    mapping[action][0] = key;
+    keymap_rebuild();
+    return 0;
+}
+
+int keymap_add_binding(TetrisAction action, SDL_Keycode key) {
+    if (action <= ACTION_NONE || action >= ACTION_COUNT || key == 0) return -1;
+    for (int i = 0; i < KEYMAP_MAX_BINDINGS; ++i) {
+        if (mapping[action][i] == key) return 0;
+        if (mapping[action][i] == 0) {
+            mapping[action][i] = key;
+            keymap_rebuild();
+            return 0;
+        }
+    }
+    return -1;  // 绑定已满
+}
+
+int keymap_set_button(int button, TetrisAction action) {
+    if (button < 0 || button >= SDL_CONTROLLER_BUTTON_MAX || action < ACTION_NONE || action >= ACTION_COUNT) return -1;
+    button_action[button] = (uint8_t)action;
+    return 0;
+}
+
+int keymap_lookup_chip8(SDL_Scancode sc) {
+    if ((int)sc <= SDL_SCANCODE_UNKNOWN || (int)sc >= SDL_NUM_SCANCODES) return -1;
+    return (int)table[sc].chip8 - 1;
+}
+
+int keymap_set_chip8_binding(int chip8_key, SDL_Keycode key) {
+    if (chip8_key < 0 || chip8_key >= CHIP8_KEY_COUNT) return -1;
+    chip8_mapping[chip8_key] = key;
+    keymap_rebuild();
+    return 0;
+}
+
+int keymap_chip8_event(Chip8* chip8, const SDL_KeyboardEvent* key) {
+    int k = keymap_lookup_chip8(key->keysym.scancode);
+    if (k < 0) return 0;
+    chip8_set_key(chip8, (uint8_t)k, key->type == SDL_KEYDOWN ? 1 : 0);
+    return 1;
+}
+
+int keymap_get_das(void) {
+    return das;
+}
+
+int keymap_get_arr(void) {
+    return arr;
+}
+
+int keymap_set_repeat(int das_ms, int arr_ms) {
+    if (das_ms < 0 || das_ms > KEYMAP_MAX_DAS || arr_ms < 0 || arr_ms > KEYMAP_MAX_ARR) return -1;
+    das = das_ms;
+    arr = arr_ms;
     return 0;
 }
 
@@ -115,7 +272,7 @@ int keymap_is_configuring(void) {
 int keymap_handle_config_key(SDL_Keycode key) {
     if (!keymap_is_configuring()) return 1;  
     // 为当前动作设置按键绑定
-    mapping[configuring_index] = key;
+    keymap_set_binding((TetrisAction)configuring_index, key);
     configuring_index++;
     // 检查是否配置完成
     if (!keymap_is_configuring()) {
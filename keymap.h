@@ -3,6 +3,7 @@
 
 #include <SDL.h>
 #include <stdint.h>
+#include "chip.h"
 
 // 俄罗斯方块游戏动作枚举
 
@@ -18,18 +19,58 @@ typedef enum {
     ACTION_COUNT           // 动作总数
 } TetrisAction;
 
+// 自动重复默认值（毫秒）：DAS为按住移动键到开始重复的延迟，ARR为重复间隔（0表示立即移到尽头）
+#define KEYMAP_DEFAULT_DAS 167
+#define KEYMAP_DEFAULT_ARR 33
+#define KEYMAP_MAX_DAS 1000
+#define KEYMAP_MAX_ARR 500
+// 每个动作最多绑定的按键数
+#define KEYMAP_MAX_BINDINGS 4
+
+// 按键查找
+// - 绑定以SDL_Keycode保存（key_config.txt格式不变：NAME=code，同一动作可出现多行表示多个绑定）
+// - 绑定变化时按当前键盘布局换算为扫描码，填入以扫描码为下标的稠密表，按键事件查表为O(1)
+// - 同一张表同时保存俄罗斯方块动作层与CHIP-8 16键小键盘层
+// - 手柄按钮另有一张以SDL_GameControllerButton为下标的表（PAD_NAME=button）
+
 
 void keymap_init(void);
 int keymap_load(const char* path);
 int keymap_save(const char* path);
 void keymap_set_default(void);
 
-// 根据SDL按键码获取对应的游戏动作
+// 根据SDL按键码获取对应的游戏动作（兼容接口，先换算扫描码再查表）
 TetrisAction keymap_get_action(SDL_Keycode key);
+// 根据扫描码查表获取游戏动作（按键事件使用ev.key.keysym.scancode）
+TetrisAction keymap_lookup(SDL_Scancode sc);
+// 根据手柄按钮获取游戏动作
+TetrisAction keymap_lookup_button(int button);
+// 键盘布局变化后重建查找表（SDL_KEYMAPCHANGED）
+void keymap_rebuild(void);
 
+// 获取动作的第一个绑定（未绑定返回0）
 SDL_Keycode keymap_get_binding(TetrisAction action);
-// 为指定动作设置新的按键绑定
+// 获取动作的全部绑定，返回绑定数
+int keymap_get_bindings(TetrisAction action, SDL_Keycode* out, int max);
+// 为指定动作设置新的按键绑定（替换该动作的全部绑定）
 int keymap_set_binding(TetrisAction action, SDL_Keycode key);
+// 为指定动作追加一个绑定（已满返回-1）
+int keymap_add_binding(TetrisAction action, SDL_Keycode key);
+// 为手柄按钮绑定动作（ACTION_NONE表示解除）
+int keymap_set_button(int button, TetrisAction action);
+
+// CHIP-8小键盘层：扫描码对应的CHIP-8按键（0x0-0xF），未映射返回-1
+// 默认按COSMAC VIP布局映射到键盘左侧 1234/QWER/ASDF/ZXCV，可用CHIP8_X=code行改绑
+int keymap_lookup_chip8(SDL_Scancode sc);
+int keymap_set_chip8_binding(int chip8_key, SDL_Keycode key);
+// 把键盘按下/松开事件转给chip8_set_key，返回1表示该键属于CHIP-8小键盘
+int keymap_chip8_event(Chip8* chip8, const SDL_KeyboardEvent* key);
+
+// 自动重复设置（与按键映射一起保存在key_config.txt中，DAS=/ARR=两行）
+int keymap_get_das(void);
+int keymap_get_arr(void);
+// 设置DAS/ARR，超出范围返回-1
+int keymap_set_repeat(int das_ms, int arr_ms);
 
 void keymap_start_config(void);
 
@@ -22,10 +22,32 @@ static void trim(char* s) {
     if (p != s) memmove(s, p, strlen(p) + 1);
 }
 
+// 预读棋盘尺寸（width:/height:，必须出现在grid:之前，缺省为标准10×20）
+static void scan_board_size(FILE* f, int* width, int* height) {
+    char line[512];
+    *width = TETRIS_WIDTH;
+    *height = TETRIS_HEIGHT;
+    while (fgets(line, sizeof(line), f)) {
+        trim(line);
+        if (line[0] == '#' || line[0] == '\0') continue;
+        char* colon = strchr(line, ':');
+        if (!colon) continue;
+        *colon = '\0';
+        char* key = line;
+        char* val = colon + 1;
+        trim(key); trim(val);
+        if (strcmp(key, "width") == 0) *width = atoi(val);
+        else if (strcmp(key, "height") == 0) *height = atoi(val);
+        else if (strcmp(key, "grid") == 0) break;
+    }
+    rewind(f);
+}
+
 // 加载关卡文件并设置游戏状态
 // 功能点：
 // - 解析文本格式的关卡文件
-// - 设置等级、分数、方块袋和游戏网格
+// - 先预读棋盘尺寸（width:/height:）并调整棋盘，再设置等级、分数、种子（seed:）、方块袋和游戏网格
+// - 网格每行一个字符串，按当前棋盘宽度读取，超出棋盘高度的行被忽略
 // - 支持版本控制和错误处理
 int tetris_load_level_file(const char* path, Tetris* t, char* errbuf, int errlen) {
     // 参数验证
@@ -49,7 +71,15 @@ int tetris_load_level_file(const char* path, Tetris* t, char* errbuf, int errlen
     char line[512];
     int grid_mode = 0;    // 是否处于网格读取模式
     int grid_row = 0;     // 当前读取的网格行号
-    // 从干净状态开始
+    // 从干净状态开始（关卡内容无法写入回放，先结束录制）
+    tetris_stop_recording(t);
+    int width, height;
+    scan_board_size(f, &width, &height);
+    if ((width != t->core.width || height != t->core.height) && tetris_set_board_size(t, width, height) != 0) {
+        fclose(f);
+        if (errbuf) snprintf(errbuf, errlen, "不支持的棋盘尺寸 %dx%d", width, height);
+        return -3;
+    }
     tetris_reset(t);
     // 默认保留洗牌后的袋子，但如果提供了bag:则会覆盖
     // 逐行解析文件
@@ -70,18 +100,17 @@ int tetris_load_level_file(const char* path, Tetris* t, char* errbuf, int errlen
             // 处理不同类型的配置项
             if (strcmp(key, "version") == 0) {
                 // 版本信息，暂时忽略
+            } else if (strcmp(key, "width") == 0 || strcmp(key, "height") == 0) {
+                // 棋盘尺寸已在预读时处理
             } else if (strcmp(key, "level") == 0) {
                 // 设置等级并重新计算下落速度
-                int lv = atoi(val);
-                if (lv < 1) lv = 1;
-                t->level = lv;
-                int new_interval = 1000 - (t->level - 1) * 100;
-                if (new_interval < 100) new_interval = 100;  // 最小间隔100ms
-                t->base_drop_interval_ms = (uint32_t)new_interval;
-                t->drop_interval_ms = (uint32_t)(t->base_drop_interval_ms / t->speed_multiplier);
+                tetris_core_set_level(&t->core, atoi(val));
+            } else if (strcmp(key, "seed") == 0) {
+                // 固定种子：重新洗牌并发出第一个方块，使关卡的方块序列可复现
+                tetris_core_reseed(&t->core, (uint32_t)strtoul(val, NULL, 0));
             } else if (strcmp(key, "score") == 0) {
                 // 设置分数
-                t->score = atoi(val);
+                t->core.score = atoi(val);
             } else if (strcmp(key, "bag") == 0) {
                 // 解析7个数字的CSV格式方块袋
                 int idx = 0;
@@ -97,10 +126,10 @@ int tetris_load_level_file(const char* path, Tetris* t, char* errbuf, int errlen
                     // 解析数字，限制在0-6范围内
                     int v = atoi(p);
                     if (v < 0 || v > 6) v = 0;
-                    t->bag[idx++] = (TetrominoId)v;
+                    t->core.bag[idx++] = (TetrominoId)v;
                     if (tmp == ',') p = end + 1; else break;
                 }
-                t->bag_index = 0;  // 重置袋子索引
+                t->core.bag_index = 0;  // 重置袋子索引
             } else if (strcmp(key, "grid") == 0) {
                 // 进入网格读取模式
                 grid_mode = 1;
@@ -108,22 +137,28 @@ int tetris_load_level_file(const char* path, Tetris* t, char* errbuf, int errlen
             }
         } else {
             // 读取网格行数据
-            if (grid_row < TETRIS_HEIGHT) {
+            if (grid_row < t->core.height) {
                 int len = (int)strlen(line);
-                for (int x = 0; x < TETRIS_WIDTH; x++) {
+                uint8_t* cells = t->core.grid + (size_t)grid_row * (size_t)t->core.width;
+                for (int x = 0; x < t->core.width; x++) {
                     // 超出行长的位置默认为'0'（空）
                     char c = (x < len) ? line[x] : '0';
-                    t->grid[grid_row][x] = (c == '1' ? 1 : 0);
+                    cells[x] = (c == '1' ? 1 : 0);
                 }
             }
             grid_row++;
-            if (grid_row >= TETRIS_HEIGHT) {
+            if (grid_row >= t->core.height) {
                 // 网格读取完成
                 // 继续读取但忽略后续行
             }
         }
     }
     fclose(f);
+    // 网格已直接写入，重建位棋盘
+    tetris_core_sync_bitboard(&t->core);
+    // 关卡内容作为撤销历史的起点
+    tetris_history_clear(&t->history);
+    tetris_history_sync(&t->history, &t->core);
     return 0;  // 成功
 }
 
@@ -10,6 +10,16 @@
 #include "save_load.h"
 #include "keymap.h"
 #include "ttf_text.h"
+#include "chip8_corpus.h"
+#include "chip8_journal.h"
+#include "chip8_audio.h"
+#include "chip8_env.h"
+#include "shm_buffer.h"
+#include "tetris_env.h"
+#include "chip8_search.h"
+#include "tetris_bot.h"
+#include "tetris_tune.h"
+#include "tetris_replay.h"
 
 /* 帮助界面已移除，相关滚动与测量函数不再需要 */
 
@@ -92,10 +102,563 @@ void render_menu(SDL_Renderer* renderer, Tetris* t, MenuItem selected_item, TTF_
 
 
 
-int main(int argc, char* argv[]) {
-    int main(int argc, char* argv[]) {
-    (void)argc; (void)argv;
+// 命令行：--chip8-corpus <目录> [--update] [--frames=N] [--cycles=N] [--threads=N]
+// 无界面运行CHIP-8一致性测试集，返回值非0表示存在失败的ROM
+static int run_chip8_corpus(int argc, char* argv[]) {
+    Chip8CorpusConfig cfg;
+    chip8_corpus_default_config(&cfg);
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--update") == 0) cfg.update_golden = 1;
+        else if (strncmp(argv[i], "--frames=", 9) == 0) cfg.frames = atoi(argv[i] + 9);
+        else if (strncmp(argv[i], "--cycles=", 9) == 0) cfg.cycles_per_frame = atoi(argv[i] + 9);
+        else if (strncmp(argv[i], "--threads=", 10) == 0) cfg.threads = atoi(argv[i] + 10);
+    }
+    return chip8_corpus_run(argv[2], &cfg, stdout) == 0 ? 0 : 1;
+}
+
+// 命令行：--chip8-replay <ROM> <日志.c8j>
+// 无界面全速回放输入日志，输出吞吐量与最终画面哈希（可作为基准负载与回归样例）
+static int run_chip8_replay(const char* rom_path, const char* journal_path) {
+    Chip8Journal journal;
+    if (chip8_journal_load(&journal, journal_path) != 0) {
+        printf("错误: 无法读取输入日志 %s\n", journal_path);
+        return 1;
+    }
+    static Chip8 chip8;
+    chip8_initialize(&chip8);
+    if (chip8_load_rom(&chip8, rom_path) != 0) {
+        chip8_journal_free(&journal);
+        return 1;
+    }
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    uint64_t executed = chip8_journal_replay(&journal, &chip8);
+    double ms = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    int ok = executed > 0 || journal.total_frames == 0;
+    if (ok) {
+        printf("回放%u帧，%llu条指令，%.2f ms，%.2f MIPS，画面哈希 %016llx\n",
+               (unsigned)journal.total_frames, (unsigned long long)executed, ms,
+               ms > 0.0 ? (double)executed / (ms * 1000.0) : 0.0,
+               (unsigned long long)chip8_hash_display(&chip8));
+    } else {
+        printf("错误: 输入日志与ROM不匹配\n");
+    }
+    chip8_journal_free(&journal);
+    return ok ? 0 : 1;
+}
+
+// 命令行：--chip8 <ROM> [--record=<日志.c8j>] [--cycles=N] [--quirks=N]
+// 交互运行CHIP-8：按键映射中的CHIP8_*绑定驱动16键小键盘，60Hz帧（每帧cycles条指令后更新定时器），ESC退出
+// 每帧定时器更新后把锁存的发声状态（sound_on）的开关边沿交给蜂鸣器（音频设备打开失败时静音运行）
+// 指定--record时每帧开始前把按键掩码写入输入日志，退出时保存（可用--chip8-replay回放或作为一致性测试集的.c8j）
+static int run_chip8_play(int argc, char* argv[]) {
+    const char* record_path = NULL;
+    int cycles = 10, quirks = 0;
+    for (int i = 3; i < argc; i++) {
+        if (strncmp(argv[i], "--record=", 9) == 0) record_path = argv[i] + 9;
+        else if (strncmp(argv[i], "--cycles=", 9) == 0) cycles = atoi(argv[i] + 9);
+        else if (strncmp(argv[i], "--quirks=", 9) == 0) quirks = (int)strtol(argv[i] + 9, NULL, 0);
+    }
+    if (cycles < 1) cycles = 1;
+    static Chip8 chip8;
+    chip8_initialize(&chip8);
+    chip8.quirks = (uint8_t)quirks;
+    if (chip8_load_rom(&chip8, argv[2]) != 0) return 1;
+    // 在执行第一条指令前开始录制（日志记录此刻的RNG状态与ROM哈希）
+    Chip8Journal journal;
+    if (record_path) chip8_journal_begin(&journal, &chip8, cycles);
+
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0) {
+        printf("SDL_Init error: %s\n", SDL_GetError());
+        if (record_path) chip8_journal_free(&journal);
+        return 1;
+    }
+    // 扫描码表依赖视频子系统建立的键盘布局，必须在SDL_Init之后加载
+    keymap_init();
+    keymap_load("key_config.txt");
+    static Chip8Audio audio;
+    chip8_audio_open(&audio, 440.0f, 0.2f);
+    int scale = 10;
+    SDL_Window* window = SDL_CreateWindow("CHIP-8", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+        CHIP8_DISPLAY_WIDTH * scale, CHIP8_DISPLAY_HEIGHT * scale, SDL_WINDOW_SHOWN);
+    SDL_Renderer* renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC) : NULL;
+    uint32_t frame = 0;
+    if (renderer) {
+        Uint64 freq = SDL_GetPerformanceFrequency();
+        Uint64 frame_ticks = freq / 60, last = SDL_GetPerformanceCounter(), acc = 0;
+        int running = 1;
+        while (running) {
+            SDL_Event ev;
+            while (SDL_PollEvent(&ev)) {
+                if (ev.type == SDL_QUIT) running = 0;
+                else if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_ESCAPE) running = 0;
+                else if ((ev.type == SDL_KEYDOWN || ev.type == SDL_KEYUP) && !ev.key.repeat) keymap_chip8_event(&chip8, &ev.key);
+                else if (ev.type == SDL_KEYMAPCHANGED) keymap_rebuild();
+            }
+            // 按墙钟推进60Hz帧（卡顿后最多追赶4帧）
+            Uint64 now = SDL_GetPerformanceCounter();
+            acc += now - last;
+            last = now;
+            if (acc > frame_ticks * 4) acc = frame_ticks * 4;
+            for (; acc >= frame_ticks; acc -= frame_ticks) {
+                if (record_path && chip8_journal_record(&journal, frame, chip8_get_key_mask(&chip8)) != 0) {
+                    printf("错误: 输入日志内存不足，停止录制\n");
+                    chip8_journal_free(&journal);
+                    record_path = NULL;
+                }
+                chip8_run_frame(&chip8, cycles);
+                chip8_audio_sync(&audio, &chip8);
+                frame++;
+            }
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
+            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+            for (int y = 0; y < CHIP8_DISPLAY_HEIGHT; y++) {
+                for (int x = 0; x < CHIP8_DISPLAY_WIDTH; x++) {
+                    if (!chip8.display[y * CHIP8_DISPLAY_WIDTH + x]) continue;
+                    SDL_Rect r = { x * scale, y * scale, scale, scale };
+                    SDL_RenderFillRect(renderer, &r);
+                }
+            }
+            SDL_RenderPresent(renderer);
+        }
+        SDL_DestroyRenderer(renderer);
+    } else {
+        printf("错误: 无法创建窗口: %s\n", SDL_GetError());
+    }
+    if (window) SDL_DestroyWindow(window);
+    chip8_audio_close(&audio);
+    SDL_Quit();
+    int rc = 0;
+    if (record_path) {
+        chip8_journal_end(&journal, frame);
+        rc = chip8_journal_save(&journal, record_path);
+        if (rc == 0) printf("输入日志已保存：%s（%u帧，%zu字节）\n", record_path, (unsigned)frame, journal.size);
+        else printf("错误: 无法写入输入日志 %s\n", record_path);
+        chip8_journal_free(&journal);
+    }
+    return rc == 0 ? 0 : 1;
+}
+
+// 棋盘格子像素大小：标准24像素，棋盘放不进avail_w×avail_h时缩小（最小1像素）
+static int board_cell_size(int width, int height, int avail_w, int avail_h) {
+    int cell = 24;
+    if (width > 0 && avail_w / width < cell) cell = avail_w / width;
+    if (height > 0 && avail_h / height < cell) cell = avail_h / height;
+    return cell < 1 ? 1 : cell;
+}
+
+// 按回放渲染：游戏时间按speed倍速跟随墙钟推进，ESC退出，回放结束后停留1秒
+static void render_tetris_replay(const TetrisReplay* replay, float speed) {
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0) {
+        printf("SDL_Init error: %s\n", SDL_GetError());
+        return;
+    }
+    int cell = board_cell_size(replay->width, replay->height, 1200, 900);
+    SDL_Window* window = SDL_CreateWindow("Tetris - Replay", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+        replay->width * cell + 2 * cell, replay->height * cell + 2 * cell, SDL_WINDOW_SHOWN);
+    SDL_Renderer* renderer = window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC) : NULL;
+    if (renderer) {
+        static Tetris game;
+        if (tetris_init(&game, renderer) != 0) {
+            printf("错误: 内存不足，无法初始化游戏\n");
+            SDL_DestroyRenderer(renderer);
+            SDL_DestroyWindow(window);
+            SDL_Quit();
+            return;
+        }
+        TetrisReplayCursor cur;
+        if (tetris_replay_prepare(replay, &game.core, &cur) != 0) {
+            printf("错误: 不支持的棋盘尺寸 %dx%d\n", replay->width, replay->height);
+        }
+        double game_ms = 0.0;
+        Uint32 last = SDL_GetTicks(), done_at = 0;
+        int running = 1;
+        while (running) {
+            SDL_Event ev;
+            while (SDL_PollEvent(&ev)) {
+                if (ev.type == SDL_QUIT || (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_ESCAPE)) running = 0;
+            }
+            Uint32 now = SDL_GetTicks();
+            game_ms += (double)(now - last) * speed;
+            last = now;
+            tetris_replay_advance(replay, &cur, &game.core, game_ms >= 4294967295.0 ? UINT32_MAX : (uint32_t)game_ms);
+            tetris_process_events(&game);
+            if (cur.done && !done_at) done_at = now;
+            if (done_at && now - done_at > 1000) running = 0;
+            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+            SDL_RenderClear(renderer);
+            tetris_render(&game, cell, cell, cell);
+            SDL_RenderPresent(renderer);
+        }
+        printf("渲染回放：%u/%u个事件，校验%s\n", (unsigned)cur.events, (unsigned)replay->event_count,
+               tetris_replay_verify(replay, &game.core) == 0 ? "一致" : "未完成或不一致");
+        SDL_DestroyRenderer(renderer);
+    } else {
+        printf("错误: 无法创建窗口: %s\n", SDL_GetError());
+    }
+    if (window) SDL_DestroyWindow(window);
+    SDL_Quit();
+}
+
+// 命令行：--tetris-replay <回放.ttr> [--render] [--speed=倍率] [--loops=次数]
+// 默认无界面全速回放（可重复多次作为规则核心的基准负载），输出吞吐量并校验结束状态与录制时一致
+static int run_tetris_replay(int argc, char* argv[]) {
+    int render = 0, loops = 1;
+    float speed = 1.0f;
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--render") == 0) render = 1;
+        else if (strncmp(argv[i], "--speed=", 8) == 0) speed = (float)atof(argv[i] + 8);
+        else if (strncmp(argv[i], "--loops=", 8) == 0) loops = atoi(argv[i] + 8);
+    }
+    TetrisReplay replay;
+    if (tetris_replay_load(&replay, argv[2]) != 0) {
+        printf("错误: 无法读取回放 %s\n", argv[2]);
+        return 1;
+    }
+    if (render) {
+        render_tetris_replay(&replay, speed > 0.0f ? speed : 1.0f);
+        tetris_replay_free(&replay);
+        return 0;
+    }
+    if (loops < 1) loops = 1;
+    static TetrisCore core;
+    if (tetris_core_init(&core, replay.width, replay.height, replay.seed) != 0) {
+        printf("错误: 不支持的棋盘尺寸 %dx%d\n", replay.width, replay.height);
+        tetris_replay_free(&replay);
+        return 1;
+    }
+    uint32_t events = 0;
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    for (int i = 0; i < loops; i++) events = tetris_replay_run(&replay, &core);
+    double ms = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    int ok = tetris_replay_verify(&replay, &core) == 0;
+    printf("回放%u个事件（%zu字节），游戏时间%.1f s，%u块 %d行 %d分\n", (unsigned)events, replay.size,
+           replay.total_ticks / 1000.0, (unsigned)core.pieces_placed, core.lines_cleared, core.score);
+    printf("%d次共%.2f ms，%.2f M事件/s，%.0f 块/s，校验%s\n", loops, ms,
+           ms > 0.0 ? (double)events * loops / (ms * 1000.0) : 0.0,
+           ms > 0.0 ? (double)core.pieces_placed * loops / (ms / 1000.0) : 0.0, ok ? "一致" : "不一致");
+    tetris_core_free(&core);
+    tetris_replay_free(&replay);
+    return ok ? 0 : 1;
+}
+
+// 保存并释放录制中的回放（录制可能已因读档被结束）
+static void finish_tetris_recording(Tetris* game, TetrisReplay* replay) {
+    tetris_stop_recording(game);
+    char msg[128];
+    if (tetris_replay_save(replay, TETRIS_REPLAY_DEFAULT_PATH) == 0) {
+        snprintf(msg, sizeof(msg), "回放已保存（%u个事件，%u字节）", (unsigned)replay->event_count, (unsigned)replay->size);
+        tetris_set_hud_message_typed(game, msg, 2000, 1);
+    } else {
+        tetris_set_hud_message_typed(game, "回放保存失败", 2000, 3);
+    }
+    tetris_replay_free(replay);
+}
+
+// 延迟统计叠加层（F3切换）：每个阶段一行p50/p99，无TTF字体时用像素字体显示整数毫秒
+static void draw_latency_overlay(SDL_Renderer* renderer, TTF_Font* font, Tetris* game) {
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 200);
+    SDL_Rect bg = { 4, 4, 360, 8 + 22 * TETRIS_LATENCY_STAGES };
+    SDL_RenderFillRect(renderer, &bg);
+    for (int s = 0; s < TETRIS_LATENCY_STAGES; s++) {
+        const TetrisLatencyHistogram* h = &game->latency.stages[s];
+        double p50 = tetris_latency_percentile(h, 50.0), p99 = tetris_latency_percentile(h, 99.0);
+        char line[128];
+        int y = 8 + 22 * s;
+        if (font) {
+            snprintf(line, sizeof(line), "%-16s n=%u p50=%.1fms p99=%.1fms", tetris_latency_stage_name((TetrisLatencyStage)s), h->count, p50, p99);
+            ttf_text_draw(renderer, font, 10, y, line, (SDL_Color){120,255,120,255});
+        } else {
+            static const char* const short_names[TETRIS_LATENCY_STAGES] = { "QUEUE", "RENDER", "PRESENT", "TOTAL" };
+            snprintf(line, sizeof(line), "%s P50 %d P99 %d", short_names[s], (int)(p50 + 0.5), (int)(p99 + 0.5));
+            tetris_draw_text(game, 10, y, line, 6);
+        }
+    }
+}
+
+// 命令行：--chip8-env-bench <ROM> [环境数] [步数] [共享内存名]
+// 以随机动作驱动向量化环境，输出每秒环境步数
+static int run_chip8_env_bench(int argc, char* argv[]) {
+    static uint8_t rom[CHIP8_MEMORY_SIZE - 0x200];
+    FILE* f = fopen(argv[2], "rb");
+    if (!f) {
+        printf("错误: 无法打开ROM文件 %s\n", argv[2]);
+        return 1;
+    }
+    size_t rom_size = fread(rom, 1, sizeof(rom), f);
+    fclose(f);
+    int num_envs = argc >= 4 ? atoi(argv[3]) : 256;
+    int steps = argc >= 5 ? atoi(argv[4]) : 1000;
+    if (num_envs < 1) num_envs = 1;
+
+    Chip8EnvConfig cfg;
+    chip8_env_default_config(&cfg, num_envs);
+    ShmBuffer obs;
+    if (shm_buffer_create(&obs, argc >= 6 ? argv[5] : NULL, chip8_env_obs_size(&cfg) * (size_t)num_envs) != 0) {
+        printf("错误: 无法创建观测缓冲区\n");
+        return 1;
+    }
+    Chip8Env env;
+    uint16_t* actions = (uint16_t*)calloc((size_t)num_envs, sizeof(uint16_t));
+    float* rewards = (float*)calloc((size_t)num_envs, sizeof(float));
+    uint8_t* dones = (uint8_t*)calloc((size_t)num_envs, 1);
+    if (!actions || !rewards || !dones || chip8_env_init(&env, &cfg, rom, rom_size, (uint8_t*)obs.ptr) != 0) {
+        printf("错误: 环境初始化失败\n");
+        free(actions); free(rewards); free(dones);
+        shm_buffer_destroy(&obs);
+        return 1;
+    }
+    chip8_env_reset(&env, 1);
+    uint32_t x = 12345;
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    for (int s = 0; s < steps; s++) {
+        for (int i = 0; i < num_envs; i++) {
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+            actions[i] = (uint16_t)(1u << (x & 15));
+        }
+        chip8_env_step(&env, actions, rewards, dones);
+    }
+    double sec = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
+    printf("%d个环境 x %d步，%.3f s，%.2f M env-steps/s\n", num_envs, steps, sec,
+           sec > 0.0 ? (double)num_envs * steps / sec / 1e6 : 0.0);
+    chip8_env_free(&env);
+    free(actions); free(rewards); free(dones);
+    shm_buffer_destroy(&obs);
+    return 0;
+}
+
+// 俄罗斯方块环境压测的单个线程：持有观测缓冲区的一个切片
+typedef struct {
+    TetrisEnv env;
+    uint8_t* actions;
+    int steps;
+    uint32_t rng;
+    TetrisEnvActionMode mode;
+} TetrisEnvBenchSlice;
+
+static int tetris_env_bench_worker(void* data) {
+    TetrisEnvBenchSlice* sl = (TetrisEnvBenchSlice*)data;
+    int n = sl->env.cfg.num_envs;
+    int range = sl->mode == TETRIS_ENV_PLACEMENTS ? 4 * TETRIS_ENV_COLUMNS : TETRIS_ENV_NUM_MOVES;
+    for (int s = 0; s < sl->steps; s++) {
+        for (int i = 0; i < n; i++) {
+            sl->rng ^= sl->rng << 13; sl->rng ^= sl->rng >> 17; sl->rng ^= sl->rng << 5;
+            sl->actions[i] = (uint8_t)((uint64_t)sl->rng * (uint32_t)range >> 32);
+        }
+        tetris_env_step(&sl->env, sl->actions, NULL, NULL);
+    }
+    return 0;
+}
+
+// 命令行：--tetris-env-bench [环境数] [步数] [线程数] [共享内存名] [--placements]
+// 以随机动作驱动向量化俄罗斯方块环境，观测缓冲区按线程切片，输出每秒环境步数
+static int run_tetris_env_bench(int argc, char* argv[]) {
+    int num_envs = argc >= 3 ? atoi(argv[2]) : 4096;
+    int steps = argc >= 4 ? atoi(argv[3]) : 1000;
+    int nthreads = argc >= 5 ? atoi(argv[4]) : SDL_GetCPUCount();
+    const char* shm_name = argc >= 6 && argv[5][0] != '-' ? argv[5] : NULL;
+    TetrisEnvActionMode mode = TETRIS_ENV_MOVES;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--placements") == 0) mode = TETRIS_ENV_PLACEMENTS;
+    }
+    if (num_envs < 1) num_envs = 1;
+    if (nthreads < 1) nthreads = 1;
+    if (nthreads > 64) nthreads = 64;
+    if (nthreads > num_envs) nthreads = num_envs;
+
+    TetrisEnvConfig cfg;
+    tetris_env_default_config(&cfg, num_envs);
+    ShmBuffer obs;
+    if (shm_buffer_create(&obs, shm_name, tetris_env_obs_size(&cfg)) != 0) {
+        printf("错误: 无法创建观测缓冲区\n");
+        return 1;
+    }
+    static TetrisEnvBenchSlice slices[64];
+    SDL_Thread* threads[64];
+    uint8_t* actions = (uint8_t*)calloc((size_t)num_envs, 1);
+    int ok = actions != NULL;
+    int initialized = 0;
+    for (int t = 0; ok && t < nthreads; t++) {
+        int lo = (int)((long long)num_envs * t / nthreads), hi = (int)((long long)num_envs * (t + 1) / nthreads);
+        TetrisEnvConfig part = cfg;
+        part.num_envs = hi - lo;
+        part.mode = mode;
+        slices[t].actions = actions + lo;
+        slices[t].steps = steps;
+        slices[t].rng = 12345u + (uint32_t)t * 7919u;
+        slices[t].mode = mode;
+        ok = tetris_env_init(&slices[t].env, &part, (TetrisEnvObs*)obs.ptr + lo) == 0;
+        if (ok) {
+            tetris_env_reset(&slices[t].env, 1u + (uint32_t)t);
+            initialized++;
+        }
+    }
+    if (ok) {
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        for (int t = 1; t < nthreads; t++) threads[t] = SDL_CreateThread(tetris_env_bench_worker, "tetris-env", &slices[t]);
+        tetris_env_bench_worker(&slices[0]);
+        for (int t = 1; t < nthreads; t++) {
+            if (threads[t]) SDL_WaitThread(threads[t], NULL);
+        }
+        double sec = (double)(SDL_GetPerformanceCounter() - t0) / (double)SDL_GetPerformanceFrequency();
+        printf("%d个环境 x %d步（%s，%d线程），%.3f s，%.2f M env-steps/s\n", num_envs, steps,
+               mode == TETRIS_ENV_PLACEMENTS ? "放置" : "按键", nthreads, sec,
+               sec > 0.0 ? (double)num_envs * steps / sec / 1e6 : 0.0);
+    } else {
+        printf("错误: 环境初始化失败\n");
+    }
+    for (int t = 0; t < initialized; t++) tetris_env_free(&slices[t].env);
+    free(actions);
+    shm_buffer_destroy(&obs);
+    return ok ? 0 : 1;
+}
+
+// 命令行：--chip8-search <ROM> <目标地址(16进制)> <目标值> [最大深度] [束宽] [随机种子]
+// 搜索使memory[目标地址]等于目标值的按键序列并输出（种子固定后CXNN可复现，默认1）
+static int run_chip8_search(int argc, char* argv[]) {
+    static Chip8 chip8;
+    chip8_initialize(&chip8);
+    if (chip8_load_rom(&chip8, argv[2]) != 0) return 1;
+    uint32_t seed = argc >= 8 ? (uint32_t)strtoul(argv[7], NULL, 0) : 1;
+    chip8_seed_rng(&chip8, seed);
+    Chip8SearchConfig cfg;
+    chip8_search_default_config(&cfg);
+    cfg.target_addr = (uint16_t)strtoul(argv[3], NULL, 16);
+    cfg.target_value = (uint8_t)atoi(argv[4]);
+    if (argc >= 6) cfg.max_depth = atoi(argv[5]);
+    if (argc >= 7) cfg.beam_width = atoi(argv[6]);
+    Chip8SearchResult result;
+    if (chip8_search_run(&chip8, &cfg, &result) != 0) {
+        printf("错误: 搜索参数无效或内存不足\n");
+        return 1;
+    }
+    printf("随机种子%u，扩展%llu个状态，重复%llu个，%.2f ms\n", seed, (unsigned long long)result.expanded,
+           (unsigned long long)result.duplicates, result.ms);
+    if (!result.found) {
+        printf("未找到满足目标的输入序列\n");
+        return 1;
+    }
+    printf("找到长度为%d的输入序列（每%d帧一次按键掩码）:", result.depth, cfg.frames_per_decision);
+    for (int i = 0; i < result.depth; i++) printf(" %04X", result.inputs[i]);
+    printf("\n");
+    return 0;
+}
+
+// 机器人路径中的核心动作对应的按键动作
+static int bot_move_action(uint8_t move) {
+    switch (move) {
+        case TETRIS_MOVE_LEFT: return ACTION_MOVE_LEFT;
+        case TETRIS_MOVE_RIGHT: return ACTION_MOVE_RIGHT;
+        case TETRIS_MOVE_ROTATE: return ACTION_ROTATE;
+        case TETRIS_MOVE_SOFT_DROP: return ACTION_SOFT_DROP;
+        default: return ACTION_HARD_DROP;
+    }
+}
+
+// 机器人配置：默认配置，检查点中有调好的权重时使用其最优权重
+static void tetris_bot_config_with_tuned(TetrisBotConfig* cfg) {
+    tetris_bot_default_config(cfg);
+    tetris_tune_load_best(TETRIS_TUNE_DEFAULT_PATH, &cfg->weights);
+}
+
+// 命令行：--tetris-tune [检查点] [--generations=N] [--population=N] [--games=N] [--pieces=N] [--threads=N] [--seed=N]
+// 无界面自我对弈调整机器人评估权重，每代写入检查点（默认tetris_tune.txt），再次运行时继续
+static int run_tetris_tune(int argc, char* argv[]) {
+    TetrisTuneConfig cfg;
+    tetris_tune_default_config(&cfg);
+    const char* checkpoint = TETRIS_TUNE_DEFAULT_PATH;
+    for (int i = 2; i < argc; i++) {
+        if (strncmp(argv[i], "--generations=", 14) == 0) cfg.generations = atoi(argv[i] + 14);
+        else if (strncmp(argv[i], "--population=", 13) == 0) cfg.population = atoi(argv[i] + 13);
+        else if (strncmp(argv[i], "--games=", 8) == 0) cfg.games = atoi(argv[i] + 8);
+        else if (strncmp(argv[i], "--pieces=", 9) == 0) cfg.max_pieces = atoi(argv[i] + 9);
+        else if (strncmp(argv[i], "--threads=", 10) == 0) cfg.threads = atoi(argv[i] + 10);
+        else if (strncmp(argv[i], "--seed=", 7) == 0) cfg.seed = (uint32_t)strtoul(argv[i] + 7, NULL, 0);
+        else if (argv[i][0] != '-') checkpoint = argv[i];
+    }
+    if (tetris_tune_run(&cfg, checkpoint, stdout, NULL) != 0) {
+        printf("错误: 调参参数无效或内存不足\n");
+        return 1;
+    }
+    return 0;
+}
+
+// 命令行：--tetris-bot [方块数] [线程数] [每块预算ms] [深度] [种子] [置换表MB]
+// 无界面让机器人连续游玩，输出消行数与决策耗时
+static int run_tetris_bot(int argc, char* argv[]) {
+    int pieces = argc >= 3 ? atoi(argv[2]) : 1000;
+    TetrisBotConfig cfg;
+    tetris_bot_config_with_tuned(&cfg);
+    if (argc >= 4) cfg.threads = atoi(argv[3]);
+    if (argc >= 5) cfg.budget_ms = atof(argv[4]);
+    if (argc >= 6) cfg.depth = atoi(argv[5]);
+    uint32_t seed = argc >= 7 ? (uint32_t)strtoul(argv[6], NULL, 0) : 1;
+    if (argc >= 8) cfg.tt_mb = atoi(argv[7]);
+    TetrisBot bot;
+    if (tetris_bot_create(&bot, &cfg) != 0) {
+        printf("错误: 无法创建机器人线程池\n");
+        return 1;
+    }
+    TetrisCore core;
+    if (tetris_core_init(&core, TETRIS_WIDTH, TETRIS_HEIGHT, seed) != 0) {
+        tetris_bot_destroy(&bot);
+        return 1;
+    }
+    double total_ms = 0.0, max_ms = 0.0;
+    unsigned long long nodes = 0, steals = 0, tt_probes = 0, tt_hits = 0;
+    while ((int)core.pieces_placed < pieces && !core.game_over) {
+        TetrisPlacement p;
+        TetrisPath path;
+        if (tetris_bot_decide(&bot, &core, &p, &path) != 0) break;
+        total_ms += bot.stats.ms;
+        if (bot.stats.ms > max_ms) max_ms = bot.stats.ms;
+        nodes += bot.stats.nodes;
+        steals += (unsigned long long)bot.stats.steals;
+        tt_probes += bot.stats.tt_probes;
+        tt_hits += bot.stats.tt_hits;
+        for (int i = 0; i < path.length; i++) tetris_core_move(&core, (TetrisMove)path.moves[i]);
+    }
+    unsigned placed = core.pieces_placed ? core.pieces_placed : 1;
+    printf("%u块，消行%d，分数%d%s，%d线程，平均%.3f ms/块（最长%.3f ms），评估%llu个棋盘，窃取%llu次，"
+           "置换表命中%.1f%%（%llu/%llu），批量评估：%s\n",
+           core.pieces_placed, core.lines_cleared, core.score, core.game_over ? "（游戏结束）" : "",
+           bot.num_workers, total_ms / placed, max_ms, nodes, steals,
+           tt_probes ? 100.0 * (double)tt_hits / (double)tt_probes : 0.0, tt_hits, tt_probes,
+           tetris_eval_simd_enabled() ? "AVX2" : "标量");
+    tetris_core_free(&core);
+    tetris_bot_destroy(&bot);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 3 && strcmp(argv[1], "--tetris-replay") == 0) {
+        return run_tetris_replay(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "--tetris-env-bench") == 0) {
+        return run_tetris_env_bench(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "--tetris-tune") == 0) {
+        return run_tetris_tune(argc, argv);
+    }
+    if (argc >= 2 && strcmp(argv[1], "--tetris-bot") == 0) {
+        return run_tetris_bot(argc, argv);
+    }
+    if (argc >= 5 && strcmp(argv[1], "--chip8-search") == 0) {
+        return run_chip8_search(argc, argv);
+    }
+    if (argc >= 3 && strcmp(argv[1], "--chip8-env-bench") == 0) {
+        return run_chip8_env_bench(argc, argv);
+    }
+    if (argc >= 3 && strcmp(argv[1], "--chip8-corpus") == 0) {
+        return run_chip8_corpus(argc, argv);
+    }
+    if (argc >= 4 && strcmp(argv[1], "--chip8-replay") == 0) {
+        return run_chip8_replay(argv[2], argv[3]);
+    }
+    if (argc >= 3 && strcmp(argv[1], "--chip8") == 0) {
+        return run_chip8_play(argc, argv);
+    }
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER) != 0) {
         printf("SDL_Init error: %s\n", SDL_GetError());
         return 1;
     }
@@ -109,7 +672,7 @@ int main(int argc, char* argv[]) {
         SDL_Quit();
         return 1;
     }
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     if (!renderer) {
         printf("CreateRenderer failed: %s\n", SDL_GetError());
         SDL_DestroyWindow(window);
@@ -117,12 +680,37 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    // 垂直同步不可用时的帧间隔（显示器刷新率，未知时按60Hz）
+    SDL_RendererInfo rinfo;
+    int vsync = SDL_GetRendererInfo(renderer, &rinfo) == 0 && (rinfo.flags & SDL_RENDERER_PRESENTVSYNC);
+    SDL_DisplayMode dmode;
+    int refresh = SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(window), &dmode) == 0 && dmode.refresh_rate > 0 ? dmode.refresh_rate : 60;
+    double frame_ms = 1000.0 / refresh;
+
     Tetris game;
-    tetris_init(&game, renderer);
+    if (tetris_init(&game, renderer) != 0) {
+        printf("错误: 内存不足，无法初始化游戏\n");
+        SDL_DestroyRenderer(renderer);
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return 1;
+    }
+    // 可选的棋盘尺寸：--board=宽x高（默认10x20）
+    for (int i = 1; i < argc; i++) {
+        int bw, bh;
+        if (strncmp(argv[i], "--board=", 8) == 0 && sscanf(argv[i] + 8, "%dx%d", &bw, &bh) == 2
+            && tetris_set_board_size(&game, bw, bh) != 0) {
+            printf("错误: 不支持的棋盘尺寸 %dx%d（宽%d-%d，高%d-%d），使用默认尺寸\n", bw, bh,
+                   TETRIS_MIN_WIDTH, TETRIS_MAX_WIDTH, TETRIS_MIN_HEIGHT, TETRIS_MAX_HEIGHT);
+        }
+    }
     keymap_init();
     if (keymap_load("key_config.txt") != 0) {
         SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_WARNING, "Keymap load failed", "Could not load key_config.txt, using defaults", window);
     }
+    tetris_set_auto_repeat(&game, keymap_get_das(), keymap_get_arr());
+    // 手柄（启动前已接入的手柄也会收到SDL_CONTROLLERDEVICEADDED事件）
+    SDL_GameController* pad = NULL;
 
     // 初始化 TTF（TrueType 字体）并加载用于菜单与模态对话框的中文字体
     TTF_Font* menu_font = NULL;
@@ -148,6 +736,21 @@ int main(int argc, char* argv[]) {
 
     int running = 1;
     static int selected_slot = 1;
+    // 自动游玩（F6切换）：机器人为每个新方块求出输入路径，逐帧通过按键动作执行
+    // 方块偏离路径（重力下落或某一步受阻）时从当前位置重新求路径
+    int autoplay = 0;
+    int bot_ready = 0;
+    static TetrisBot bot;
+    TetrisPath bot_path;
+    int bot_path_pos = 0;
+    uint32_t bot_piece = 0;
+    int bot_x = 0, bot_y = 0, bot_rot = 0;  // 按路径执行上一步后方块应处的位置
+    bot_path.length = 0;
+    // 回放录制（F10切换）：结束时写入TETRIS_REPLAY_DEFAULT_PATH
+    static TetrisReplay replay;
+    int recording = 0;
+    // 输入延迟统计：F3显示/隐藏叠加层，F4导出到TETRIS_LATENCY_DEFAULT_PATH
+    int show_latency = 0;
     // 左侧按钮相关状态（仅用于绘制与键盘选择反馈）
     int left_hover = -1;
     int left_selected = -1;
@@ -281,9 +884,9 @@ int main(int argc, char* argv[]) {
                 SDL_GetWindowSize(window, &win_w, &win_h);
                 int left_w = btn_w;
                 int left_total_h = left_count * btn_h + (left_count - 1) * btn_gap;
-                int play_cell = 24;
-                int play_w = TETRIS_WIDTH * play_cell;
-                int play_h = TETRIS_HEIGHT * play_cell;
+                int play_cell = board_cell_size(game.core.width, game.core.height, win_w / 2, win_h - 80);
+                int play_w = game.core.width * play_cell;
+                int play_h = game.core.height * play_cell;
                 // 如果可用 TTF（TrueType 字体），测量右侧标签宽度以估算右侧区域宽度
                 int max_label_w = 0;
                 if (menu_font) {
@@ -491,7 +1094,6 @@ int main(int argc, char* argv[]) {
                     case GAME_STATE_PAUSED:
                         if (sym == SDLK_SPACE) {
                             game_state = GAME_STATE_PLAYING;
-                            game.last_drop_time = SDL_GetTicks();
                             tetris_set_hud_message(&game, "继续", 800);
                         } else if (sym == SDLK_ESCAPE) {
                             game_state = GAME_STATE_MENU;
@@ -533,6 +1135,47 @@ int main(int argc, char* argv[]) {
                                 } else {
                                     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Load failed", err, window);
                                 }
+                            } else if (sym == SDLK_F6) {
+                                if (!bot_ready) {
+                                    TetrisBotConfig bcfg;
+                                    tetris_bot_config_with_tuned(&bcfg);
+                                    bot_ready = tetris_bot_create(&bot, &bcfg) == 0;
+                                }
+                                autoplay = bot_ready && !autoplay;
+                                bot_path.length = 0;
+                                bot_path_pos = 0;
+                                tetris_set_hud_message(&game, autoplay ? "自动游玩: 开" : "自动游玩: 关", 1200);
+                            } else if ((sym == SDLK_z || sym == SDLK_y) && (mod & KMOD_CTRL)) {
+                                // 撤销/重做：Ctrl+Z回到上一个方块开始下落时，Ctrl+Y前进（按住Shift一次10步）
+                                int step = (mod & KMOD_SHIFT) ? 10 : 1;
+                                int moved = tetris_rewind(&game, sym == SDLK_z ? -step : step);
+                                bot_path.length = 0;
+                                bot_path_pos = 0;
+                                char msg[64];
+                                snprintf(msg, sizeof(msg), "%s %d步（可撤销%d，可重做%d）", sym == SDLK_z ? "撤销" : "重做",
+                                         moved < 0 ? -moved : moved, tetris_history_undo_count(&game.history),
+                                         tetris_history_redo_count(&game.history));
+                                tetris_set_hud_message(&game, msg, 1200);
+                            } else if (sym == SDLK_F3) {
+                                show_latency = !show_latency;
+                            } else if (sym == SDLK_F4) {
+                                if (tetris_latency_dump(&game.latency, TETRIS_LATENCY_DEFAULT_PATH) == 0) {
+                                    tetris_set_hud_message_typed(&game, "延迟统计已导出", 1500, 1);
+                                } else {
+                                    tetris_set_hud_message_typed(&game, "延迟统计导出失败", 1500, 3);
+                                }
+                            } else if (sym == SDLK_F10) {
+                                if (recording) {
+                                    finish_tetris_recording(&game, &replay);
+                                    recording = 0;
+                                } else {
+                                    // 录制总是从新的一局开始
+                                    tetris_replay_begin(&replay, &game.core, tetris_core_random(&game.core));
+                                    tetris_sync_clock(&game, tetris_clock_ms());
+                                    game.recorder = &replay;
+                                    recording = 1;
+                                    tetris_set_hud_message(&game, "开始录制回放", 1200);
+                                }
                             } else if (sym == SDLK_1 || sym == SDLK_KP_1) {
                                 selected_slot = 1;
                                 char msg[64]; snprintf(msg, sizeof(msg), "选中 存档 %d", selected_slot);
@@ -572,7 +1215,7 @@ int main(int argc, char* argv[]) {
                             } else {
                                 // 处理已映射的按键行为（由 keymap 提供）
                                 // 包括新增的速度增加/减少两个动作（ACTION_SPEED_UP / ACTION_SPEED_DOWN）
-                                TetrisAction act = keymap_get_action(sym);
+                                TetrisAction act = keymap_lookup(ev.key.keysym.scancode);
                                 if (act != ACTION_NONE) {
                                     if (act == ACTION_SPEED_UP) {
                                         float cur = tetris_get_speed_multiplier(&game);
@@ -590,13 +1233,14 @@ int main(int argc, char* argv[]) {
                                         char msgsp[64];
                                         snprintf(msgsp, sizeof(msgsp), "速度: %d%%", (int)(cur * 100.0f));
                                         tetris_set_hud_message(&game, msgsp, 1200);
-                                    } else {
-                                        tetris_perform_action(&game, (int)act);
+                                    } else if (!ev.key.repeat) {
+                                        // 系统按键重复忽略，按住移动由模拟内的DAS/ARR处理
+                                        tetris_queue_action(&game, (int)act, ev.key.timestamp);
                                     }
                                 } else {
                                     // 严格映射模式：忽略未映射的游戏按键（避免固化的默认控制干扰）
                                     // 允许在 game over 状态下按 'r' 重启游戏（方便测试）
-                                    if (game.game_over && sym == SDLK_r) {
+                                    if (game.core.game_over && sym == SDLK_r) {
                                         tetris_reset(&game);
                                         tetris_set_hud_message(&game, "已重启", 800);
                                     }
@@ -605,6 +1249,30 @@ int main(int argc, char* argv[]) {
                         }
                         break;
                 }
+            } else if (ev.type == SDL_KEYUP) {
+                // 松开已映射的按键：结束该动作的自动重复
+                if (game_state == GAME_STATE_PLAYING && !keymap_is_configuring()) {
+                    TetrisAction act = keymap_lookup(ev.key.keysym.scancode);
+                    if (act != ACTION_NONE) tetris_queue_release(&game, (int)act, ev.key.timestamp);
+                }
+            } else if (ev.type == SDL_KEYMAPCHANGED) {
+                // 键盘布局变化：按新布局重新换算绑定的扫描码
+                keymap_rebuild();
+            } else if (ev.type == SDL_CONTROLLERDEVICEADDED) {
+                // 使用第一个接入的手柄
+                if (!pad && SDL_IsGameController(ev.cdevice.which)) pad = SDL_GameControllerOpen(ev.cdevice.which);
+            } else if (ev.type == SDL_CONTROLLERDEVICEREMOVED) {
+                if (pad && !SDL_GameControllerGetAttached(pad)) {
+                    SDL_GameControllerClose(pad);
+                    pad = NULL;
+                }
+            } else if (ev.type == SDL_CONTROLLERBUTTONDOWN || ev.type == SDL_CONTROLLERBUTTONUP) {
+                // 手柄按钮与键盘走同一条按时间戳排队的路径（按钮没有系统重复）
+                TetrisAction act = keymap_lookup_button(ev.cbutton.button);
+                if (game_state == GAME_STATE_PLAYING && act != ACTION_NONE) {
+                    if (ev.type == SDL_CONTROLLERBUTTONDOWN) tetris_queue_action(&game, (int)act, ev.cbutton.timestamp);
+                    else tetris_queue_release(&game, (int)act, ev.cbutton.timestamp);
+                }
             } else if (ev.type == SDL_DROPFILE && game_state == GAME_STATE_PLAYING && !show_level_dialog) {
                 char* dropped = ev.drop.file;
                 char err[256] = {0};
@@ -614,7 +1282,7 @@ int main(int argc, char* argv[]) {
                     SDL_SetWindowTitle(window, title);
                     char msg[256];
                     snprintf(msg, sizeof(msg), "Loaded level - Score: %d, Level: %d, Lines: %d",
-                            game.score, game.level, game.lines_cleared);
+                            game.core.score, game.core.level, game.core.lines_cleared);
                     tetris_set_hud_message_typed(&game, msg, 4000, 1); // 成功提示
                 } else {
                     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Load failed", err, window);
@@ -629,7 +1297,7 @@ int main(int argc, char* argv[]) {
                         SDL_SetWindowTitle(window, title);
                         char msg[256];
                         snprintf(msg, sizeof(msg), "已加载关卡 - 分数: %d, 等级: %d, 消行: %d",
-                                game.score, game.level, game.lines_cleared);
+                                game.core.score, game.core.level, game.core.lines_cleared);
                         tetris_set_hud_message_typed(&game, msg, 4000, 1); // 成功提示
                         show_level_dialog = 0;
                         game_state = GAME_STATE_PLAYING;
@@ -738,12 +1406,12 @@ int main(int argc, char* argv[]) {
                         }
                     } else {
                         // 将按键映射为动作（通过 keymap 查找），若存在则执行对应动作
-                        TetrisAction act = keymap_get_action(ev.key.keysym.sym);
+                        TetrisAction act = keymap_lookup(ev.key.keysym.scancode);
                         if (act != ACTION_NONE) {
-                            tetris_perform_action(&game, (int)act);
+                            if (!ev.key.repeat) tetris_queue_action(&game, (int)act, ev.key.timestamp);
                         } else {
                             // 严格映射：不回退到硬编码控制。仅在 game over 状态下允许按 'r' 快速重启以便测试。
-                            if (game.game_over && ev.key.keysym.sym == SDLK_r) {
+                            if (game.core.game_over && ev.key.keysym.sym == SDLK_r) {
                                 tetris_reset(&game);
                                 tetris_set_hud_message(&game, "已重启", 800);
                             }
@@ -753,9 +1421,47 @@ int main(int argc, char* argv[]) {
             }
         }
                 // 根据当前游戏状态更新逻辑并执行绘制
+        double now = tetris_clock_ms();
+        // 非游戏状态下模拟时钟跟随当前时间（暂停期间不累计下落时间）
+        if (game_state != GAME_STATE_PLAYING) tetris_sync_clock(&game, now);
         if (game_state == GAME_STATE_PLAYING || game_state == GAME_STATE_PAUSED) {
-            uint32_t now = SDL_GetTicks();
-            if (game_state == GAME_STATE_PLAYING) tetris_update(&game, now);
+            if (game_state == GAME_STATE_PLAYING) {
+                if (autoplay && !game.core.game_over) {
+                    // 新方块、路径执行完毕或方块不在预期位置时重新决策，每帧执行一步
+                    TetrisCore* core = &game.core;
+                    if (bot_piece != core->pieces_placed || bot_path_pos >= bot_path.length
+                        || core->current_x != bot_x || core->current_y != bot_y || core->current_rot != bot_rot) {
+                        TetrisPlacement target;
+                        bot_path_pos = 0;
+                        if (tetris_bot_decide(&bot, core, &target, &bot_path) != 0) bot_path.length = 0;
+                        bot_piece = core->pieces_placed;
+                        bot_x = core->current_x;
+                        bot_y = core->current_y;
+                        bot_rot = core->current_rot;
+                    }
+                    if (bot_path_pos < bot_path.length) {
+                        TetrisMove move = (TetrisMove)bot_path.moves[bot_path_pos++];
+                        tetris_perform_action(&game, bot_move_action(move));
+                        // 移动受阻（位置不变）说明局面已与搜索时不同，放弃剩余步骤
+                        if (move != TETRIS_MOVE_HARD_DROP && core->current_x == bot_x
+                            && core->current_y == bot_y && core->current_rot == bot_rot) {
+                            bot_path.length = 0;
+                        }
+                        bot_x = core->current_x;
+                        bot_y = core->current_y;
+                        bot_rot = core->current_rot;
+                    }
+                }
+                // 固定步长推进，按键按时间戳落入对应的步
+                tetris_advance(&game, now);
+            }
+            // 模拟之后统一处理事件（音效、HUD），不在规则推进路径上
+            tetris_process_events(&game);
+            // 读档或加载关卡会结束录制，此时保存已录制的部分
+            if (recording && !game.recorder) {
+                finish_tetris_recording(&game, &replay);
+                recording = 0;
+            }
 
             SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
             SDL_RenderClear(renderer);
@@ -765,9 +1471,9 @@ int main(int argc, char* argv[]) {
             SDL_GetWindowSize(window, &win_w, &win_h);
             int left_w = btn_w;
             int left_total_h = left_count * btn_h + (left_count - 1) * btn_gap;
-            int play_cell = 24;
-            int play_w = TETRIS_WIDTH * play_cell;
-            int play_h = TETRIS_HEIGHT * play_cell;
+            int play_cell = board_cell_size(game.core.width, game.core.height, win_w / 2, win_h - 80);
+            int play_w = game.core.width * play_cell;
+            int play_h = game.core.height * play_cell;
             int max_label_w = 0;
             if (menu_font) {
                 const char* labels_tmp[] = { "下一个", "分数", "等级", "消行", "速度" };
@@ -834,7 +1540,7 @@ int main(int argc, char* argv[]) {
             if (game_state == GAME_STATE_PAUSED) {
                 // 在 playfield 上绘制半透明遮罩（用于暂停状态的视觉提示）
                 int px = play_px, py = play_py, cell = play_cell;
-                SDL_Rect area = { px, py, TETRIS_WIDTH * cell, TETRIS_HEIGHT * cell };
+                SDL_Rect area = { px, py, game.core.width * cell, game.core.height * cell };
                 SDL_SetRenderDrawColor(renderer, 0, 0, 0, 160);
                 SDL_RenderFillRect(renderer, &area);
                 // 在遮罩中央绘制“暂停”文字（支持 TTF（TrueType 字体）与像素字体回退）
@@ -859,7 +1565,7 @@ int main(int argc, char* argv[]) {
             // 右侧面板：左侧为标签，右侧为数值或预览
             // 布局规则：将“下一个”预览顶部与 playfield 顶部对齐，速度项与 playfield 底部对齐
             const int play_cell2 = play_cell;
-            const int play_h2 = TETRIS_HEIGHT * play_cell2;
+            const int play_h2 = game.core.height * play_cell2;
             const char* labels[] = { "下一个", "分数", "等级", "消行", "速度" };
             int label_count = 5;
             int max_label_w2 = max_label_w;
@@ -871,7 +1577,7 @@ int main(int argc, char* argv[]) {
             int preview_y = play_py; // 与左侧 playfield 顶部对齐
             ttf_text_draw(renderer, menu_font, label_x, preview_y, labels[0], (SDL_Color){255,255,255,255});
             TetrominoId next_id = TET_NONE;
-            if (game.bag_index < 7) next_id = game.bag[game.bag_index];
+            if (game.core.bag_index < 7) next_id = game.core.bag[game.core.bag_index];
             if (next_id != TET_NONE) tetris_render_preview(&game, next_id, preview_x, preview_y + 24, preview_cell);
             // 计算预览底部到 playfield 底部之间的可用区域，用于放置中间的统计项（分数/等级/消行）
             int preview_bottom = preview_y + 24 + 4 * preview_cell; // +24 考虑标签文本高度
@@ -890,30 +1596,30 @@ int main(int argc, char* argv[]) {
             pos_y[3] = play_bottom - 36;
             // 绘制 分数/等级/消行/速度：左侧为标签，右侧为数值
             ttf_text_draw(renderer, menu_font, label_x, pos_y[0], labels[1], (SDL_Color){255,255,255,255});
-            snprintf(buf, sizeof(buf), "%d", game.score);
+            snprintf(buf, sizeof(buf), "%d", game.core.score);
             ttf_text_draw(renderer, menu_font, value_x, pos_y[0], buf, (SDL_Color){255,255,255,255});
             ttf_text_draw(renderer, menu_font, label_x, pos_y[1], labels[2], (SDL_Color){255,255,255,255});
-            snprintf(buf, sizeof(buf), "%d", game.level);
+            snprintf(buf, sizeof(buf), "%d", game.core.level);
             ttf_text_draw(renderer, menu_font, value_x, pos_y[1], buf, (SDL_Color){255,255,255,255});
             ttf_text_draw(renderer, menu_font, label_x, pos_y[2], labels[3], (SDL_Color){255,255,255,255});
-            snprintf(buf, sizeof(buf), "%d", game.lines_cleared);
+            snprintf(buf, sizeof(buf), "%d", game.core.lines_cleared);
             ttf_text_draw(renderer, menu_font, value_x, pos_y[2], buf, (SDL_Color){255,255,255,255});
             ttf_text_draw(renderer, menu_font, label_x, pos_y[3], labels[4], (SDL_Color){255,255,255,255});
-            snprintf(buf, sizeof(buf), "%.0f%%", game.speed_multiplier * 100.0f);
+            snprintf(buf, sizeof(buf), "%.0f%%", game.core.speed_multiplier * 100.0f);
             ttf_text_draw(renderer, menu_font, value_x, pos_y[3], buf, (SDL_Color){255,255,255,255});
             } else {
                 // 没有 TTF（TrueType 字体）时回退到像素字体显示的布局
                 tetris_draw_text(&game, sidebar_x, y, "SCORE", 12);
-                snprintf(buf, sizeof(buf), "%d", game.score);
+                snprintf(buf, sizeof(buf), "%d", game.core.score);
                 tetris_draw_text(&game, sidebar_x, y + 36, buf, 10);
                 tetris_draw_text(&game, sidebar_x, y + 80, "LEVEL", 12);
-                snprintf(buf, sizeof(buf), "%d", game.level);
+                snprintf(buf, sizeof(buf), "%d", game.core.level);
                 tetris_draw_text(&game, sidebar_x, y + 116, buf, 10);
                 tetris_draw_text(&game, sidebar_x, y + 160, "LINES", 12);
-                snprintf(buf, sizeof(buf), "%d", game.lines_cleared);
+                snprintf(buf, sizeof(buf), "%d", game.core.lines_cleared);
                 tetris_draw_text(&game, sidebar_x, y + 196, buf, 10);
                 tetris_draw_text(&game, sidebar_x, y + 240, "SPEED", 12);
-                snprintf(buf, sizeof(buf), "%.0f%%", game.speed_multiplier * 100.0f);
+                snprintf(buf, sizeof(buf), "%.0f%%", game.core.speed_multiplier * 100.0f);
                 tetris_draw_text(&game, sidebar_x, y + 276, buf, 10);
             }
             // 当存在模态对话框（保存/读取/关卡）时绘制弹窗 UI
@@ -1231,12 +1937,27 @@ int main(int argc, char* argv[]) {
                 tetris_draw_text(&game, 200, 520, instr, 12);
             }
         }
+        if (show_latency && (game_state == GAME_STATE_PLAYING || game_state == GAME_STATE_PAUSED)) {
+            draw_latency_overlay(renderer, modal_font, &game);
+        }
+        // 延迟采样：提交渲染与上屏（垂直同步时SDL_RenderPresent阻塞到交换缓冲区）
+        tetris_latency_submit(&game.latency, tetris_clock_ms());
         SDL_RenderPresent(renderer);
-        SDL_Delay(16);
+        tetris_latency_present(&game.latency, tetris_clock_ms());
+        // 没有垂直同步时按显示器刷新率限制帧率（模拟不依赖帧率，这里只为节省CPU）
+        if (!vsync) {
+            double frame_end = now + frame_ms;
+            double left = frame_end - tetris_clock_ms();
+            if (left > 1.0) SDL_Delay((Uint32)(left - 1.0));
+            while (tetris_clock_ms() < frame_end) {}
+        }
     }
+    if (bot_ready) tetris_bot_destroy(&bot);
+    if (recording) finish_tetris_recording(&game, &replay);
     if (menu_font) ttf_text_free_font(menu_font);
     if (modal_font) ttf_text_free_font(modal_font);
     ttf_text_quit();
+    if (pad) SDL_GameControllerClose(pad);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
@@ -23,6 +23,13 @@ static int ensure_save_dir(void) {
     return 0;
 }
 
+// 网格之后、分数之前的字节数：方块袋(7) + 袋子索引(1) + 方块ID(1) + 旋转(4) + 位置(8) + 下落间隔(4) + 速度倍率(4)
+#define SAVE_SCORE_AFTER_GRID 29
+// 版本1/2的文件头（魔数 + 版本）与固定10×20网格
+#define SAVE_V2_HEADER 5
+// 版本3的文件头：魔数 + 版本 + 宽度(1字节) + 高度(2字节)
+#define SAVE_V3_HEADER 8
+
 // 生成指定存档槽的文件路径
 static const char* slot_path(int slot) {
     static char path[256];
@@ -56,37 +63,46 @@ int tetris_save_slot(Tetris* t, int slot, char* errbuf, int errlen) {
     }
     // 写入文件头
     fwrite("TSAV", 1, 4, f);  // 魔数标识
-    uint8_t version = 1;
+    uint8_t version = 3;
     fwrite(&version, 1, 1, f);  // 版本号
+    // 版本3：写入棋盘尺寸，网格按尺寸逐行存放
+    uint8_t width = (uint8_t)t->core.width;
+    uint16_t height = (uint16_t)t->core.height;
+    fwrite(&width, 1, 1, f);
+    fwrite(&height, sizeof(height), 1, f);
     // 写入游戏网格
-    for (int y = 0; y < TETRIS_HEIGHT; y++) {
-        fwrite(t->grid[y], 1, TETRIS_WIDTH, f);
-    }
-    // 写入方块袋序列
-    fwrite(t->bag, 1, 7, f);
-    uint8_t bag_index = (uint8_t)t->bag_index;
+    fwrite(t->core.grid, 1, (size_t)t->core.width * (size_t)t->core.height, f);
+    // 写入方块袋序列（每个方块ID占1字节）
+    uint8_t bag[7];
+    for (int i = 0; i < 7; i++) bag[i] = (uint8_t)t->core.bag[i];
+    fwrite(bag, 1, 7, f);
+    uint8_t bag_index = (uint8_t)t->core.bag_index;
     fwrite(&bag_index, 1, 1, f);
     // 写入当前方块状态
-    uint8_t current_id = (uint8_t)t->current_id;
+    uint8_t current_id = (uint8_t)t->core.current_id;
     fwrite(&current_id, 1, 1, f);
-    int32_t current_rot = t->current_rot;
+    int32_t current_rot = t->core.current_rot;
     fwrite(&current_rot, sizeof(current_rot), 1, f);
     // 写入当前方块位置
-    int32_t cx = t->current_x, cy = t->current_y;
+    int32_t cx = t->core.current_x, cy = t->core.current_y;
     fwrite(&cx, sizeof(cx), 1, f);
     fwrite(&cy, sizeof(cy), 1, f);
     // 写入游戏参数
-    uint32_t base_int = t->base_drop_interval_ms;
+    // 基础下落间隔（毫秒/行，由重力换算，20G等每tick超过一行时为0；仅为兼容旧格式，读档时按等级重新计算）
+    uint32_t base_int = (uint32_t)((uint64_t)TETRIS_GRAVITY_ONE / (t->core.base_gravity ? t->core.base_gravity : 1));
     fwrite(&base_int, sizeof(base_int), 1, f);
-    float speed = t->speed_multiplier;
+    float speed = t->core.speed_multiplier;
     fwrite(&speed, sizeof(speed), 1, f);
     // 写入统计数据
-    int32_t score = t->score;
+    int32_t score = t->core.score;
     fwrite(&score, sizeof(score), 1, f);
-    int32_t level = t->level;
+    int32_t level = t->core.level;
     fwrite(&level, sizeof(level), 1, f);
-    int32_t lines = t->lines_cleared;
+    int32_t lines = t->core.lines_cleared;
     fwrite(&lines, sizeof(lines), 1, f);
+    // 版本2：追加种子和随机数状态（放在末尾，分数/等级的偏移保持不变）
+    fwrite(&t->core.seed, sizeof(uint32_t), 1, f);
+    fwrite(t->core.rng, sizeof(uint32_t), 4, f);
 
     fclose(f);
     return 0;
@@ -127,61 +143,99 @@ int tetris_load_slot(Tetris* t, int slot, char* errbuf, int errlen) {
     // 检查版本
     uint8_t version = 0;
     fread(&version, 1, 1, f);
-    if (version != 1) {
+    if (version < 1 || version > 3) {
         fclose(f);
         if (errbuf) snprintf(errbuf, errlen, "不支持的版本");
         return -5;
     }
-    // 读取游戏网格
-    for (int y = 0; y < TETRIS_HEIGHT; y++) {
-        if (fread(t->grid[y], 1, TETRIS_WIDTH, f) != TETRIS_WIDTH) {
+    // 棋盘尺寸（版本1/2固定为10×20）
+    int width = TETRIS_WIDTH, height = TETRIS_HEIGHT;
+    if (version >= 3) {
+        uint8_t w = 0;
+        uint16_t h = 0;
+        if (fread(&w, 1, 1, f) != 1 || fread(&h, sizeof(h), 1, f) != 1) {
             fclose(f);
             if (errbuf) snprintf(errbuf, errlen, "文件不完整");
             return -6;
         }
+        width = w;
+        height = h;
+    }
+    // 读档内容无法写入回放，先结束录制
+    tetris_stop_recording(t);
+    // 尺寸不同时先调整棋盘（同时清空撤销历史）
+    if ((width != t->core.width || height != t->core.height) && tetris_set_board_size(t, width, height) != 0) {
+        fclose(f);
+        if (errbuf) snprintf(errbuf, errlen, "不支持的棋盘尺寸 %dx%d", width, height);
+        return -6;
+    }
+    // 读取游戏网格
+    size_t cells = (size_t)width * (size_t)height;
+    if (fread(t->core.grid, 1, cells, f) != cells) {
+        fclose(f);
+        if (errbuf) snprintf(errbuf, errlen, "文件不完整");
+        return -6;
     }
-    // 读取方块袋
-    if (fread(t->bag, 1, 7, f) != 7) {
+    tetris_core_sync_bitboard(&t->core);
+    // 读取方块袋（版本1的写入有误，ID可能越界，统一限制到0-6）
+    uint8_t bag[7];
+    if (fread(bag, 1, 7, f) != 7) {
         fclose(f);
         if (errbuf) snprintf(errbuf, errlen, "文件不完整");
         return -7;
     }
+    for (int i = 0; i < 7; i++) t->core.bag[i] = (TetrominoId)(bag[i] <= TET_L ? bag[i] : TET_I);
     // 读取方块袋状态
     uint8_t bag_index = 0;
     fread(&bag_index, 1, 1, f);
-    t->bag_index = bag_index;
+    t->core.bag_index = bag_index;
     // 读取当前方块
     uint8_t current_id = 0;
     fread(&current_id, 1, 1, f);
-    t->current_id = (TetrominoId)current_id;
+    t->core.current_id = (TetrominoId)current_id;
     int32_t current_rot = 0;
     fread(&current_rot, sizeof(current_rot), 1, f);
-    t->current_rot = current_rot;
+    t->core.current_rot = current_rot;
     // 读取当前方块位置
     int32_t cx = 0, cy = 0;
     fread(&cx, sizeof(cx), 1, f);
     fread(&cy, sizeof(cy), 1, f);
-    t->current_x = cx; t->current_y = cy;
+    t->core.current_x = cx; t->core.current_y = cy;
     // 读取游戏参数
     uint32_t base_int = 0;
     fread(&base_int, sizeof(base_int), 1, f);
-    t->base_drop_interval_ms = base_int;
     float speed = 1.0f;
     fread(&speed, sizeof(speed), 1, f);
-    t->speed_multiplier = speed;
+    t->core.speed_multiplier = speed;
     // 读取统计数据
     int32_t score = 0;
     fread(&score, sizeof(score), 1, f);
-    t->score = score;
+    t->core.score = score;
     int32_t level = 1;
     fread(&level, sizeof(level), 1, f);
-    t->level = level;
     int32_t lines = 0;
     fread(&lines, sizeof(lines), 1, f);
-    t->lines_cleared = lines;
-    // 重新计算下落间隔
-    if (t->speed_multiplier <= 0.0f) t->speed_multiplier = 1.0f;
-    t->drop_interval_ms = (uint32_t)(t->base_drop_interval_ms / t->speed_multiplier);
+    t->core.lines_cleared = lines;
+    // 读取随机数状态（版本1没有，保留当前局的随机数继续发牌）
+    if (version >= 2) {
+        uint32_t seed = 0, rng[4] = { 0, 0, 0, 0 };
+        if (fread(&seed, sizeof(seed), 1, f) == 1 && fread(rng, sizeof(uint32_t), 4, f) == 4
+            && (rng[0] | rng[1] | rng[2] | rng[3])) {
+            t->core.seed = seed;
+            memcpy(t->core.rng, rng, sizeof(rng));
+        }
+    }
+    // 按等级与速度倍率重新计算重力（存档中的下落间隔只用于兼容旧版本），从零开始锁定计时
+    if (t->core.speed_multiplier <= 0.0f) t->core.speed_multiplier = 1.0f;
+    tetris_core_set_level(&t->core, level);
+    tetris_core_set_speed_multiplier(&t->core, t->core.speed_multiplier);
+    t->core.gravity_acc = 0;
+    t->core.lock_timer = 0;
+    t->core.lock_resets = 0;
+    t->core.lowest_y = t->core.current_y;
+    // 读档后从新状态重新开始撤销历史
+    tetris_history_clear(&t->history);
+    tetris_history_sync(&t->history, &t->core);
 
     fclose(f);
     return 0;
@@ -193,8 +247,15 @@ int tetris_read_slot_info(int slot, int* out_score, int* out_level, char* timest
     const char* path = slot_path(slot);
     FILE* f = fopen(path, "rb");
     if (!f) return -2;
-    
-    long offset = 234; 
+    // 分数的偏移由版本与棋盘尺寸决定（版本1/2为5 + 200 + 29 = 234）
+    uint8_t head[SAVE_V3_HEADER];
+    if (fread(head, 1, SAVE_V2_HEADER, f) != SAVE_V2_HEADER) { fclose(f); return -3; }
+    long offset = SAVE_V2_HEADER + TETRIS_WIDTH * TETRIS_HEIGHT + SAVE_SCORE_AFTER_GRID;
+    if (head[4] >= 3) {
+        uint16_t h = 0;
+        if (fread(head + SAVE_V2_HEADER, 1, 1, f) != 1 || fread(&h, sizeof(h), 1, f) != 1) { fclose(f); return -3; }
+        offset = SAVE_V3_HEADER + (long)head[SAVE_V2_HEADER] * (long)h + SAVE_SCORE_AFTER_GRID;
+    }
     if (fseek(f, offset, SEEK_SET) != 0) { fclose(f); return -3; }
     // 读取分数和等级
     int32_t score = 0, level = 0;
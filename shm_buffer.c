@@ -0,0 +1,69 @@
+// ftruncate/shm_open为POSIX接口，-std=c11下需在包含任何头文件前声明特性宏
+#define _POSIX_C_SOURCE 200809L
+#include "shm_buffer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+int shm_buffer_create(ShmBuffer* b, const char* name, size_t size) {
+    memset(b, 0, sizeof(*b));
+    b->size = size;
+    // 普通堆内存（无共享需求）
+    if (!name || !name[0]) {
+        b->ptr = calloc(1, size);
+        return b->ptr ? 0 : -1;
+    }
+    snprintf(b->name, sizeof(b->name), "%s", name);
+#ifdef _WIN32
+    DWORD hi = (DWORD)((unsigned long long)size >> 32), lo = (DWORD)(size & 0xFFFFFFFFu);
+    HANDLE h = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, hi, lo, name);
+    if (!h) return -1;
+    b->ptr = MapViewOfFile(h, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (!b->ptr) {
+        CloseHandle(h);
+        return -2;
+    }
+    b->handle = h;
+#else
+    b->fd = shm_open(name, O_CREAT | O_RDWR, 0600);
+    if (b->fd < 0) return -1;
+    if (ftruncate(b->fd, (off_t)size) != 0) {
+        close(b->fd);
+        shm_unlink(name);
+        return -2;
+    }
+    b->ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, b->fd, 0);
+    if (b->ptr == MAP_FAILED) {
+        b->ptr = NULL;
+        close(b->fd);
+        shm_unlink(name);
+        return -3;
+    }
+#endif
+    memset(b->ptr, 0, size);
+    return 0;
+}
+
+void shm_buffer_destroy(ShmBuffer* b) {
+    if (!b->ptr) return;
+    if (!b->name[0]) {
+        free(b->ptr);
+    } else {
+#ifdef _WIN32
+        UnmapViewOfFile(b->ptr);
+        CloseHandle((HANDLE)b->handle);
+#else
+        munmap(b->ptr, b->size);
+        close(b->fd);
+        shm_unlink(b->name);
+#endif
+    }
+    memset(b, 0, sizeof(*b));
+}
@@ -0,0 +1,26 @@
+#ifndef SHM_BUFFER_H
+#define SHM_BUFFER_H
+
+#include <stddef.h>
+
+// 连续内存缓冲区，可选放在命名共享内存中（POSIX shm_open / Windows文件映射）
+// 训练进程按同名映射即可直接读取，不需要拷贝
+typedef struct {
+    void* ptr;        // 映射/分配后的地址
+    size_t size;      // 字节数
+    char name[64];    // 共享内存名（空字符串表示普通堆内存）
+#ifdef _WIN32
+    void* handle;     // 文件映射句柄
+#else
+    int fd;           // shm_open返回的描述符
+#endif
+} ShmBuffer;
+
+// 创建缓冲区并清零：name为NULL或空串时使用普通堆内存，否则创建命名共享内存
+// （POSIX名称需以'/'开头，例如 "/chip8_obs"），成功返回0
+int shm_buffer_create(ShmBuffer* b, const char* name, size_t size);
+
+// 释放缓冲区；命名共享内存会被解除映射并删除名称
+void shm_buffer_destroy(ShmBuffer* b);
+
+#endif // SHM_BUFFER_H
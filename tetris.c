@@ -3,28 +3,10 @@
 #include <stdlib.h>
 #include <time.h>
 #include <stdio.h>
-#include <math.h>
 #include <SDL.h>
 #include "keymap.h"
-
-// 俄罗斯方块形状定义：7种方块×4种旋转状态
-// 每个旋转状态用16位二进制表示（按行主序排列的4x4网格）
-static const uint16_t tetromino_shapes[7][4] = {
-    // I形方块（条形）
-    { 0x0F00, 0x2222, 0x00F0, 0x4444 },
-    // O形方块（正方形）
-    { 0x6600, 0x6600, 0x6600, 0x6600 },
-    // T形方块
-    { 0x0E40, 0x4C40, 0x04E0, 0x4640 },
-    // S形方块
-    { 0x06C0, 0x8C40, 0x06C0, 0x8C40 },
-    // Z形方块
-    { 0x0C60, 0x4C80, 0x0C60, 0x4C80 },
-    // J形方块
-    { 0x08E0, 0x44C0, 0x0E20, 0xC880 },
-    // L形方块
-    { 0x02E0, 0x88C0, 0x0E80, 0xC440 }
-};
+#include "tetris_audio.h"
+#include "tetris_pieces.h"
 
 // 俄罗斯方块颜色定义（I、O、T、S、Z、J、L）
 static const SDL_Color tetromino_colors[7] = {
@@ -37,211 +19,57 @@ static const SDL_Color tetromino_colors[7] = {
     {240, 160, 0, 255}    // L - 橙色
 };
 
-// 洗牌袋算法：生成随机方块序列
-// 功能点：
-// - 填充袋子数组（0-6对应7种方块）
-// - 使用Fisher-Yates洗牌算法确保随机性
-// - 重置袋子索引为0
-static void shuffle_bag(Tetris* t) {
-    // 填充袋子数组（7种方块ID：0-6）
-    for (int i = 0; i < 7; i++) t->bag[i] = (TetrominoId)i;
-    // Fisher-Yates洗牌算法：从后往前随机交换位置
-    for (int i = 6; i > 0; i--) {
-        int j = rand() % (i + 1);
-        TetrominoId tmp = t->bag[i];
-        t->bag[i] = t->bag[j];
-        t->bag[j] = tmp;
-    }
-    t->bag_index = 0;
-}
-
-// 检查方块形状中的特定单元格是否被占用
-// 参数：
-// - shape: 16位方块形状数据
-// - rx, ry: 相对坐标（0-3范围）
-// 返回：1表示该位置有方块，0表示空位
-static int shape_cell(uint16_t shape, int rx, int ry) {
-    // rx,ry范围：0..3
-    // 计算位移：从高位到低位，从右到左
-    int bit = (shape >> ((3 - ry) * 4 + (3 - rx))) & 1;
-    return bit;
-}
-
-// 碰撞检测函数
-// 功能点：
-// - 检查方块在指定位置和旋转状态下是否会发生碰撞
-// - 检测边界碰撞和与其他已放置方块的碰撞
-// 参数：
-// - id: 方块类型
-// - rot: 旋转状态
-// - x, y: 方块左上角在游戏网格中的位置
-// 返回：1表示碰撞，0表示无碰撞
-static int check_collision(Tetris* t, TetrominoId id, int rot, int x, int y) {
-    uint16_t shape = tetromino_shapes[id][rot & 3];
-    // 遍历4x4方块形状中的每个单元格
-    for (int ry = 0; ry < 4; ry++) {
-        for (int rx = 0; rx < 4; rx++) {
-            if (shape_cell(shape, rx, ry)) {
-                // 计算在游戏网格中的绝对坐标
-                int gx = x + rx;
-                int gy = y + ry;
-                // 边界检测：超出左右边界或上下边界
-                if (gx < 0 || gx >= TETRIS_WIDTH || gy < 0 || gy >= TETRIS_HEIGHT) return 1;
-                // 方块重叠检测：该位置已有其他方块
-                if (t->grid[gy][gx]) return 1;
-            }
-        }
-    }
-    return 0;
-}
-
-// 锁定当前方块到游戏网格中
-// 功能点：
-// - 将当前下落方块固定到游戏网格上
-// - 每个方块ID存储为(id + 1)，避免0值冲突
-// - 只锁定在有效边界内的方块单元
-static void lock_piece(Tetris* t) {
-    TetrominoId id = t->current_id;
-    uint16_t shape = tetromino_shapes[id][t->current_rot & 3];
-    // 遍历方块形状，将占用的单元格写入网格
-    for (int ry = 0; ry < 4; ry++) {
-        for (int rx = 0; rx < 4; rx++) {
-            if (shape_cell(shape, rx, ry)) {
-                // 计算网格坐标
-                int gx = t->current_x + rx;
-                int gy = t->current_y + ry;
-                // 确保在有效边界内才写入
-                if (gx >= 0 && gx < TETRIS_WIDTH && gy >= 0 && gy < TETRIS_HEIGHT) {
-                    // 存储为(id + 1)，避免与空单元格(0)冲突
-                    t->grid[gy][gx] = (uint8_t)(id + 1);
-                }
-            }
-        }
-    }
-}
-
-// 消行检测和处理函数
-// 功能点：
-// - 从底部开始逐行检查是否满行
-// - 发现满行时，将上方所有行向下移动
-// - 清空顶部行，准备新行
-// - 重新检查同一行（因为上方行下移后可能又变满）
-// 返回：清除的行数
-static int clear_lines(Tetris* t) {
-    int cleared = 0;
-    // 从底部行开始向上检查（便于行下移操作）
-    for (int y = TETRIS_HEIGHT - 1; y >= 0; y--) {
-        int full = 1;
-        // 检查当前行是否每列都有方块
-        for (int x = 0; x < TETRIS_WIDTH; x++) {
-            if (!t->grid[y][x]) {
-                full = 0;
-                break;
-            }
-        }
-        if (full) {
-            // 找到满行，将上方所有行向下移动一行
-            for (int yy = y; yy > 0; yy--) {
-                memcpy(t->grid[yy], t->grid[yy-1], TETRIS_WIDTH);
-            }
-            // 清空最顶行
-            memset(t->grid[0], 0, TETRIS_WIDTH);
-            cleared++;
-            y++; // 重新检查当前行号（因为上方行已下移）
-        }
-    }
-    return cleared;
-}
-
-// 消行得分计算辅助函数
-// 功能点：
-// - 根据一次性消行数量计算基础得分
-// - 应用当前等级倍率
-// - 标准俄罗斯方块得分规则：1行=100分，2行=300分，3行=500分，4行=800分
-static int score_for_cleared(int lines, int level) {
-    if (lines <= 0) return 0;
-    int base = 0;
-    // 根据消行数量确定基础得分
-    switch (lines) {
-        case 1: base = 100; break;  // 单行消：100分
-        case 2: base = 300; break;  // 双行消：300分
-        case 3: base = 500; break;  // 三行消：500分
-        case 4: base = 800; break;  // 四行消：800分
-        default: base = 100 * lines; break;  // 多行消的简单计算
-    }
-    // 应用等级倍率（至少1级）
-    return base * (level > 0 ? level : 1);
-}
-
-// --- 音频支持模块（通过SDL_QueueAudio生成简单音调）---
-// 全局音频设备和规格变量
-static SDL_AudioDeviceID g_audio_dev = 0;
-static SDL_AudioSpec g_audio_spec;
+// --- 音频支持模块（回调式合成，见tetris_audio.h）---
+// 全局音效设备（所有Tetris实例共用）
+static TetrisAudio g_audio;
+static int g_audio_opened = 0;
 
-// 初始化音频系统
-// 功能点：
-// - 配置音频参数（44.1kHz，32位浮点，单声道）
-// - 打开默认音频设备
-// - 音频初始化失败时静默继续（不中断游戏）
+// 初始化音频系统（打开失败时静默继续，不中断游戏）
 static void tetris_audio_init(void) {
-    if (g_audio_dev) return;  // 已初始化则跳过
-    SDL_zero(g_audio_spec);
-    // 配置音频规格：44.1kHz采样率，32位浮点格式，单声道，4096样本缓冲区
-    g_audio_spec.freq = 44100;
-    g_audio_spec.format = AUDIO_F32SYS;
-    g_audio_spec.channels = 1;
-    g_audio_spec.samples = 4096;
-    g_audio_dev = SDL_OpenAudioDevice(NULL, 0, &g_audio_spec, NULL, 0);
-    if (g_audio_dev == 0) {
-        // 音频初始化失败；继续运行但无音频
-        SDL_Log("SDL_OpenAudioDevice failed: %s", SDL_GetError());
-    } else {
-        SDL_PauseAudioDevice(g_audio_dev, 0);  // 启动音频播放
-    }
-}
-
-// 播放指定频率和时长的音调
-// 参数：
-// - freq_hz: 频率（Hz）
-// - ms: 时长（毫秒）
-// - volume: 音量（0.0-1.0）
-static void tetris_play_tone(float freq_hz, int ms, float volume) {
-    if (!g_audio_dev) return;  // 无音频设备则跳过
-    // 计算需要的样本数
-    int samples = (int)(g_audio_spec.freq * (ms / 1000.0f));
-    if (samples <= 0) return;
-    // 分配音频缓冲区
-    float* buf = (float*)malloc(sizeof(float) * samples);
-    if (!buf) return;
-    // 生成正弦波音调
-    const float two_pi_f = 2.0f * 3.14159265f * freq_hz;
-    for (int i = 0; i < samples; i++) {
-        float t = (float)i / (float)g_audio_spec.freq;
-        // 简单正弦波 + 线性衰减包络
-        float env = 1.0f - (float)i / (float)samples;  // 线性衰减
-        buf[i] = volume * env * sinf(two_pi_f * t);
-    }
-    // 队列音频数据并释放缓冲区
-    SDL_QueueAudio(g_audio_dev, buf, samples * sizeof(float));
-    free(buf);
+    if (g_audio_opened) return;  // 已初始化则跳过
+    g_audio_opened = 1;
+    tetris_audio_open(&g_audio);
 }
 
 // 播放方块着陆音效
 static void tetris_play_landing(void) {
-    tetris_play_tone(220.0f, 80, 0.25f);
+    tetris_audio_play(&g_audio, 220.0f, 80, 0.25f, 0);
 }
 
 // 播放消行音效序列
 static void tetris_play_lineclear(void) {
-    // 序列：短促的下降音调
-    tetris_play_tone(880.0f, 80, 0.25f);   // 高音
-    tetris_play_tone(660.0f, 80, 0.25f);   // 中音
-    tetris_play_tone(440.0f, 120, 0.25f);  // 低音（稍长）
+    // 序列：短促的下降音调，依次错开开始时间
+    tetris_audio_play(&g_audio, 880.0f, 80, 0.25f, 0);     // 高音
+    tetris_audio_play(&g_audio, 660.0f, 80, 0.25f, 80);    // 中音
+    tetris_audio_play(&g_audio, 440.0f, 120, 0.25f, 160);  // 低音（稍长）
 }
 
 // 播放升级音效
 static void tetris_play_levelup(void) {
-    tetris_play_tone(1000.0f, 150, 0.35f);
+    tetris_audio_play(&g_audio, 1000.0f, 150, 0.35f, 0);
+}
+
+// 处理规则核心的事件环
+// 功能点：
+// - 每帧在模拟之后调用一次，取走本帧产生的全部事件
+// - 转换为音效（只写入音频环，不等待设备）与HUD提示
+void tetris_process_events(Tetris* t) {
+    if (!t) return;
+    TetrisEvent ev;
+    while (tetris_core_poll_event(&t->core, &ev)) {
+        switch (ev.type) {
+            case TETRIS_EVENT_LOCK: tetris_play_landing(); break;       // 着陆音效
+            case TETRIS_EVENT_CLEAR: tetris_play_lineclear(); break;    // 消行音效
+            case TETRIS_EVENT_LEVEL_UP: {                               // 升级音效与提示
+                char msg[64];
+                snprintf(msg, sizeof(msg), "升级！等级 %d", ev.value);
+                tetris_play_levelup();
+                tetris_set_hud_message_typed(t, msg, 1500, 1);
+                break;
+            }
+            default: break;
+        }
+    }
 }
 
 // 使用位图数字绘制小数字的辅助函数
@@ -343,140 +171,235 @@ void tetris_draw_text(Tetris* t, int x, int y, const char* text, int cell_size)
 void tetris_render_preview(Tetris* t, TetrominoId id, int px, int py, int cell_size) {
     if (!t || !t->renderer) return;
     if (id < 0 || id > TET_L) return;
-    // 预览使用旋转状态0
-    uint16_t shape = tetromino_shapes[id][0];
-    // 渲染4x4预览区域
-    for (int ry = 0; ry < 4; ry++) {
-        for (int rx = 0; rx < 4; rx++) {
-            if (shape_cell(shape, rx, ry)) {
-                // 使用方块对应的颜色
-                SDL_Color c = tetromino_colors[id];
-                SDL_SetRenderDrawColor(t->renderer, c.r, c.g, c.b, c.a);
-                SDL_Rect r = { px + rx * cell_size, py + ry * cell_size, cell_size, cell_size };
-                SDL_RenderFillRect(t->renderer, &r);
-            }
+    // 预览使用旋转状态0（x=0时行掩码的位rx即4x4区域第rx列）
+    const TetrisPieceBox* b = &tetris_piece_boxes[id][0];
+    SDL_Color c = tetromino_colors[id];
+    SDL_SetRenderDrawColor(t->renderer, c.r, c.g, c.b, c.a);
+    for (int ry = b->min_y; ry <= b->max_y; ry++) {
+        for (uint64_t m = tetris_piece_row(id, 0, 0, ry); m; m &= m - 1) {
+            SDL_Rect r = { px + tetris_lowest_bit(m) * cell_size, py + ry * cell_size, cell_size, cell_size };
+            SDL_RenderFillRect(t->renderer, &r);
         }
     }
 }
 
+// 为新的一局生成种子（时间与高精度计数器混合，同一秒内重开也不同）
+static uint32_t tetris_fresh_seed(void) {
+    Uint64 pc = SDL_GetPerformanceCounter();
+    return (uint32_t)time(NULL) ^ (uint32_t)pc ^ (uint32_t)(pc >> 32);
+}
+
 // 初始化俄罗斯方块游戏状态
 // 功能点：
 // - 清零所有游戏数据
 // - 设置默认游戏参数（下落间隔、速度倍率等）
 // - 初始化音频系统
 // - 随机化种子并生成第一个方块
-void tetris_init(Tetris* t, SDL_Renderer* renderer) {
-    if (!t) return;
+int tetris_init(Tetris* t, SDL_Renderer* renderer) {
+    if (!t) return -1;
     // 清零结构体
     memset(t, 0, sizeof(*t));
     t->renderer = renderer;
-    // 设置默认游戏参数
-    t->base_drop_interval_ms = 1000;  // 基础下落间隔1秒
-    t->speed_multiplier = 1.0f;       // 默认速度倍率
-    t->drop_interval_ms = (uint32_t)(t->base_drop_interval_ms / t->speed_multiplier);
-    t->score = 0;                     // 初始分数
-    t->level = 1;                     // 初始等级
-    t->lines_cleared = 0;             // 已消行数
     // 初始化音频（尽力而为，不影响游戏运行）
     tetris_audio_init();
-    // 设置随机种子
-    srand((unsigned)time(NULL));
-    // 生成初始方块序列
-    shuffle_bag(t);
-    // 生成第一个下落方块
-    t->current_id = t->bag[t->bag_index++];
-    if (t->bag_index >= 7) shuffle_bag(t);
-    t->current_rot = 0;      // 初始旋转状态
-    t->current_x = 3;        // 初始X坐标（居中）
-    t->current_y = 0;        // 初始Y坐标（顶部）
+    // 初始化规则核心：标准10×20棋盘、默认速度、等级1、以新种子生成方块序列和第一个下落方块
+    if (tetris_core_init(&t->core, TETRIS_WIDTH, TETRIS_HEIGHT, tetris_fresh_seed()) != 0) {
+        SDL_Log("tetris_core_init failed: out of memory");
+        return -2;
+    }
+    tetris_history_sync(&t->history, &t->core);
     t->last_drop_time = SDL_GetTicks();
+    t->das_ms = KEYMAP_DEFAULT_DAS;
+    t->arr_ms = KEYMAP_DEFAULT_ARR;
     // 保留draw_default_hud设置（由main.c控制）
+    return 0;
 }
 
 // 重置游戏状态（用于重新开始游戏）
 // 功能点：
-// - 清空游戏网格
-// - 重置所有游戏统计数据
-// - 重新生成方块序列
-// - 生成新的下落方块
+// - 以新种子重置规则核心（清空网格、统计数据、速度参数，重新生成方块序列）
+// - 重新开始下落计时
 void tetris_reset(Tetris* t) {
-    // 清空游戏网格
-    memset(t->grid, 0, sizeof(t->grid));
-    // 重置游戏统计
-    t->score = 0;
-    t->level = 1;
-    t->lines_cleared = 0;
-    t->game_over = 0;
-    // 重置游戏速度参数
-    t->base_drop_interval_ms = 1000;
-    t->speed_multiplier = 1.0f;
-    t->drop_interval_ms = (uint32_t)(t->base_drop_interval_ms / t->speed_multiplier);
-    // 重新生成方块序列
-    shuffle_bag(t);
-    // 生成新的下落方块
-    t->current_id = t->bag[t->bag_index++];
-    t->current_rot = 0;
-    t->current_x = 3;
-    t->current_y = 0;
+    uint32_t seed = tetris_fresh_seed();
+    if (t->recorder) tetris_replay_record_reset(t->recorder, seed);
+    tetris_core_reset(&t->core, seed);
+    tetris_history_clear(&t->history);
+    tetris_history_sync(&t->history, &t->core);
     t->last_drop_time = SDL_GetTicks();
     // 启用默认HUD绘制
     t->draw_default_hud = 1;
 }
 
+// 改变棋盘尺寸
+// 功能点：
+// - 录制中的回放按录制开始时的尺寸复现，先结束录制
+// - 调整规则核心的棋盘并以新种子开始新的一局，撤销历史从新局面重新开始（非标准尺寸不录入）
+// - 丢弃排队的输入和按住状态
+int tetris_set_board_size(Tetris* t, int width, int height) {
+    if (!t) return -1;
+    if (t->recorder) tetris_stop_recording(t);
+    // 与tetris_reset一样用新的随机种子开局
+    int ret = tetris_core_resize(&t->core, width, height, tetris_fresh_seed());
+    if (ret != 0) return ret;
+    tetris_history_clear(&t->history);
+    tetris_history_sync(&t->history, &t->core);
+    tetris_sync_clock(t, t->sim_ms);
+    return 0;
+}
+
 // 已移除：tetris_handle_key函数（旧的按键处理逻辑，已由keymap系统完全替代）
 // 原函数已删除以减少代码冗余
 
 // 更新游戏状态（处理自动下落和方块锁定）
 // 功能点：
-// - 根据时间间隔自动下移方块
-// - 处理方块着陆、消行、得分计算
-// - 检测游戏结束条件
-// - 生成新的下落方块
+// - 把距上次调用经过的毫秒数作为tick交给规则核心（可变步长，回放渲染等场合使用；游戏主循环使用tetris_advance）
+// - 方块锁定后录入撤销快照
+// - 产生的事件留在核心事件环中，由tetris_process_events在帧末统一处理
+static void advance_ticks(Tetris* t, uint32_t ticks) {
+    // 录制时跳过不会改变状态的推进（游戏结束，或0 tick且未到锁定时间）
+    if (t->recorder && !t->core.game_over && (ticks > 0 || t->core.lock_timer >= t->core.lock_delay)) {
+        tetris_replay_record_tick(t->recorder, ticks);
+    }
+    tetris_core_tick(&t->core, ticks);
+    tetris_history_sync(&t->history, &t->core);
+}
+
 void tetris_update(Tetris* t, uint32_t now_ms) {
     if (!t) return;
-    // 检查是否到达下落时间间隔
-    if (now_ms - t->last_drop_time >= t->drop_interval_ms) {
-        t->last_drop_time = now_ms;
-        // 尝试向下移动方块
-        if (!check_collision(t, t->current_id, t->current_rot, t->current_x, t->current_y + 1)) {
-            t->current_y++;  // 无碰撞则下移
-        } else {
-            // 方块无法下移：锁定到网格
-            lock_piece(t);
-            tetris_play_landing();  // 播放着陆音效
-            // 处理消行
-            int c = clear_lines(t);
-            if (c > 0) {
-                tetris_play_lineclear();  // 播放消行音效
-                // 计算得分
-                int gained = score_for_cleared(c, t->level);
-                t->score += gained;
-                t->lines_cleared += c;
-                // 检查等级提升（每10行升一级）
-                int new_level = 1 + (t->lines_cleared / 10);
-                if (new_level != t->level) {
-                    t->level = new_level;
-                    // 根据等级调整下落速度
-                    int new_interval = 1000 - (t->level - 1) * 100;
-                    if (new_interval < 100) new_interval = 100;  // 最小间隔100ms
-                    t->base_drop_interval_ms = (uint32_t)new_interval;
-                    t->drop_interval_ms = (uint32_t)(t->base_drop_interval_ms / t->speed_multiplier);
-                    tetris_play_levelup();  // 播放升级音效
-                }
-            }
-            // 生成下一个方块
-            t->current_id = t->bag[t->bag_index++];
-            if (t->bag_index >= 7) shuffle_bag(t);  // 袋子用完重新洗牌
-            t->current_rot = 0;
-            t->current_x = 3;
-            t->current_y = 0;
-            // 检查新方块是否能生成（碰撞检测）
-            if (check_collision(t, t->current_id, t->current_rot, t->current_x, t->current_y)) {
-                t->game_over = 1;  // 生成失败，游戏结束
-                return; // 不生成方块
+    uint32_t elapsed = now_ms - t->last_drop_time;
+    t->last_drop_time = now_ms;
+    advance_ticks(t, elapsed);
+}
+
+void tetris_set_auto_repeat(Tetris* t, int das_ms, int arr_ms) {
+    if (!t) return;
+    t->das_ms = das_ms < 0 ? 0 : das_ms;
+    t->arr_ms = arr_ms < 0 ? 0 : arr_ms;
+}
+
+// 按下：立即执行一次；左右移动开始DAS计时（后按下的方向优先），软降按ARR重复
+static void press_action(Tetris* t, int action) {
+    tetris_perform_action(t, action);
+    if (action == ACTION_MOVE_LEFT || action == ACTION_MOVE_RIGHT) {
+        t->held |= 1u << action;
+        t->shift_action = action;
+        t->shift_timer = t->das_ms;
+    } else if (action == ACTION_SOFT_DROP) {
+        t->held |= 1u << action;
+        t->drop_timer = t->arr_ms;
+    }
+}
+
+// 松开：另一方向仍按住时改由该方向重新开始DAS计时
+static void release_action(Tetris* t, int action) {
+    if (action <= ACTION_NONE || action >= ACTION_COUNT) return;
+    t->held &= ~(1u << action);
+    if (action != t->shift_action) return;
+    int other = action == ACTION_MOVE_LEFT ? ACTION_MOVE_RIGHT : ACTION_MOVE_LEFT;
+    if (t->held & (1u << other)) {
+        t->shift_action = other;
+        t->shift_timer = t->das_ms;
+    } else {
+        t->shift_action = ACTION_NONE;
+    }
+}
+
+// 排队一个按下/松开（队列满时立即处理）
+static void queue_input(Tetris* t, int action, int pressed, double time_ms) {
+    if (t->input_head - t->input_tail >= TETRIS_INPUT_QUEUE_SIZE) {
+        if (pressed) press_action(t, action);
+        else release_action(t, action);
+        return;
+    }
+    TetrisQueuedInput* in = &t->inputs[t->input_head & (TETRIS_INPUT_QUEUE_SIZE - 1)];
+    in->time_ms = time_ms;
+    in->action = action;
+    in->pressed = pressed;
+    t->input_head++;
+}
+
+void tetris_queue_action(Tetris* t, int action, double time_ms) {
+    if (t) queue_input(t, action, 1, time_ms);
+}
+
+void tetris_queue_release(Tetris* t, int action, double time_ms) {
+    if (t) queue_input(t, action, 0, time_ms);
+}
+
+// 重复一次移动：被挡住时不执行（也不录制），返回0
+static int repeat_move(Tetris* t, int action) {
+    const TetrisCore* c = &t->core;
+    if (c->game_over) return 0;
+    int dx = action == ACTION_MOVE_LEFT ? -1 : (action == ACTION_MOVE_RIGHT ? 1 : 0);
+    int dy = action == ACTION_SOFT_DROP ? 1 : 0;
+    if (tetris_core_collides(c, c->current_id, c->current_rot, c->current_x + dx, c->current_y + dy)) return 0;
+    tetris_perform_action(t, action);
+    return 1;
+}
+
+// 推进一个按住动作的重复计时
+// 功能点：
+// - 计时到0后每arr_ms毫秒重复一次，一步内可重复多次
+// - ARR为0时一次移到尽头
+// - 被挡住时保持已蓄满的状态，下一个方块出现后立即继续移动
+static void repeat_held(Tetris* t, int action, int* timer) {
+    *timer -= TETRIS_STEP_TICKS;
+    while (*timer <= 0) {
+        if (t->arr_ms == 0) {
+            while (repeat_move(t, action)) {}
+            *timer = 0;
+            return;
+        }
+        if (!repeat_move(t, action)) {
+            *timer = 0;
+            return;
+        }
+        *timer += t->arr_ms;
+    }
+}
+
+// 固定步长推进
+// 功能点：
+// - 每步覆盖[sim_ms, sim_ms + 步长)，时间戳早于步结束的排队动作在该步开始时执行（输入精度为一步而不是一帧）
+// - 按住的动作先按DAS/ARR推进重复，再处理本步新的按下/松开
+// - 落后超过TETRIS_MAX_CATCHUP_MS时丢弃多余的时间
+// - 剩余不足一步的时间换算为render_alpha，供渲染插值
+int tetris_advance(Tetris* t, double now_ms) {
+    if (!t) return 0;
+    if (now_ms - t->sim_ms > TETRIS_MAX_CATCHUP_MS) t->sim_ms = now_ms - TETRIS_MAX_CATCHUP_MS;
+    int steps = 0;
+    while (t->sim_ms + TETRIS_STEP_TICKS <= now_ms) {
+        double step_end = t->sim_ms + TETRIS_STEP_TICKS;
+        if (t->shift_action != ACTION_NONE) repeat_held(t, t->shift_action, &t->shift_timer);
+        if (t->held & (1u << ACTION_SOFT_DROP)) repeat_held(t, ACTION_SOFT_DROP, &t->drop_timer);
+        while (t->input_tail != t->input_head && t->inputs[t->input_tail & (TETRIS_INPUT_QUEUE_SIZE - 1)].time_ms < step_end) {
+            const TetrisQueuedInput* in = &t->inputs[t->input_tail & (TETRIS_INPUT_QUEUE_SIZE - 1)];
+            int action = in->action, pressed = in->pressed;
+            double event_ms = in->time_ms;
+            t->input_tail++;
+            if (pressed) {
+                press_action(t, action);
+                tetris_latency_action(&t->latency, event_ms, tetris_clock_ms());
+            } else {
+                release_action(t, action);
             }
         }
+        advance_ticks(t, TETRIS_STEP_TICKS);
+        t->sim_ms = step_end;
+        steps++;
     }
+    t->render_alpha = (float)((now_ms - t->sim_ms) / TETRIS_STEP_TICKS);
+    return steps;
+}
+
+void tetris_sync_clock(Tetris* t, double now_ms) {
+    if (!t) return;
+    t->sim_ms = now_ms;
+    t->render_alpha = 0.0f;
+    t->input_tail = t->input_head;
+    // 暂停期间的松开事件不会送达，恢复时从未按住状态开始
+    t->held = 0;
+    t->shift_action = ACTION_NONE;
 }
 
 // 设置游戏速度倍率
@@ -485,19 +408,14 @@ void tetris_update(Tetris* t, uint32_t now_ms) {
 // - 自动重新计算实际下落间隔
 void tetris_set_speed_multiplier(Tetris* t, float mul) {
     if (!t) return;
-    // 限制倍率范围
-    if (mul < 0.5f) mul = 0.5f;
-    if (mul > 2.0f) mul = 2.0f;
-    t->speed_multiplier = mul;
-    // 重新计算实际下落间隔
-    if (t->base_drop_interval_ms == 0) t->base_drop_interval_ms = 1000;
-    t->drop_interval_ms = (uint32_t)(t->base_drop_interval_ms / t->speed_multiplier);
+    if (t->recorder) tetris_replay_record_speed(t->recorder, mul);
+    tetris_core_set_speed_multiplier(&t->core, mul);
 }
 
 // 获取当前速度倍率
 float tetris_get_speed_multiplier(Tetris* t) {
     if (!t) return 1.0f;
-    return t->speed_multiplier;
+    return t->core.speed_multiplier;
 }
 
 // 设置HUD消息（无类型，默认信息类型）
@@ -534,76 +452,38 @@ void tetris_set_hud_message_typed(Tetris* t, const char* msg, uint32_t duration_
 // 执行游戏动作（由keymap系统调用）
 // 功能点：
 // - 处理所有游戏控制动作（移动、旋转、降落等）
-// - 每个动作都包含完整的游戏逻辑（碰撞检测、状态更新、音效播放）
+// - 按键动作映射为核心动作，规则由核心执行（音效由帧末的事件处理播放）
+// - 录制中时先把核心动作写入回放
 void tetris_perform_action(Tetris* t, int action) {
     if (!t) return;
+    TetrisMove move;
     switch (action) {
-        case ACTION_MOVE_LEFT:
-            // 左移：检查碰撞后移动
-            if (!check_collision(t, t->current_id, t->current_rot, t->current_x - 1, t->current_y))
-                t->current_x--;
-            break;
-        case ACTION_MOVE_RIGHT:
-            // 右移：检查碰撞后移动
-            if (!check_collision(t, t->current_id, t->current_rot, t->current_x + 1, t->current_y))
-                t->current_x++;
-            break;
-        case ACTION_SOFT_DROP:
-            // 软降：向下移动一行
-            if (!check_collision(t, t->current_id, t->current_rot, t->current_x, t->current_y + 1))
-                t->current_y++;
-            break;
-        case ACTION_HARD_DROP:
-            // 硬降：直接降到底部
-            while (!check_collision(t, t->current_id, t->current_rot, t->current_x, t->current_y + 1))
-                t->current_y++;
-            // 锁定方块并处理完整游戏逻辑
-            lock_piece(t);
-            {
-                tetris_play_landing();  // 着陆音效
-                int c = clear_lines(t);  // 消行处理
-                if (c > 0) {
-                    tetris_play_lineclear();  // 消行音效
-                    // 得分计算
-                    int gained = score_for_cleared(c, t->level);
-                    t->score += gained;
-                    t->lines_cleared += c;
-                    // 等级提升检测
-                    int new_level = 1 + (t->lines_cleared / 10);
-                    if (new_level != t->level) {
-                        t->level = new_level;
-                        // 调整下落速度
-                        int new_interval = 1000 - (t->level - 1) * 100;
-                        if (new_interval < 100) new_interval = 100;
-                        t->base_drop_interval_ms = (uint32_t)new_interval;
-                        t->drop_interval_ms = (uint32_t)(t->base_drop_interval_ms / t->speed_multiplier);
-                        tetris_play_levelup();  // 升级音效
-                    }
-                }
-                // 生成下一个方块
-                t->current_id = t->bag[t->bag_index++];
-                if (t->bag_index >= 7) shuffle_bag(t);
-                t->current_rot = 0;
-                t->current_x = 3;
-                t->current_y = 0;
-                // 检查游戏结束条件
-                if (check_collision(t, t->current_id, t->current_rot, t->current_x, t->current_y)) {
-                    tetris_reset(t);  // 无法生成方块，重启游戏
-                }
-            }
-            break;
-        case ACTION_ROTATE:
-            // 顺时针旋转
-            {
-                int newrot = (t->current_rot + 1) & 3;
-                if (!check_collision(t, t->current_id, newrot, t->current_x, t->current_y))
-                    t->current_rot = newrot;
-            }
-            break;
+        case ACTION_MOVE_LEFT: move = TETRIS_MOVE_LEFT; break;         // 左移
+        case ACTION_MOVE_RIGHT: move = TETRIS_MOVE_RIGHT; break;       // 右移
+        case ACTION_SOFT_DROP: move = TETRIS_MOVE_SOFT_DROP; break;    // 软降
+        case ACTION_HARD_DROP: move = TETRIS_MOVE_HARD_DROP; break;    // 硬降并锁定
+        case ACTION_ROTATE: move = TETRIS_MOVE_ROTATE; break;          // 顺时针旋转
         default:
             // 未知动作，忽略
-            break;
+            return;
     }
+    if (t->recorder) tetris_replay_record_move(t->recorder, move);
+    tetris_core_move(&t->core, move);
+    tetris_history_sync(&t->history, &t->core);
+}
+
+// 结束录制（回放文件由调用者保存与释放）
+void tetris_stop_recording(Tetris* t) {
+    if (!t || !t->recorder) return;
+    tetris_replay_end(t->recorder, &t->core);
+    t->recorder = NULL;
+}
+
+// 撤销/重做
+int tetris_rewind(Tetris* t, int delta) {
+    if (!t) return 0;
+    tetris_stop_recording(t);
+    return tetris_history_step(&t->history, &t->core, delta);
 }
 
 // 渲染俄罗斯方块游戏界面
@@ -616,19 +496,20 @@ void tetris_render(Tetris* t, int px, int py, int cell_size) {
     if (!t || !t->renderer) return;
     // 清空游戏区域（假设背景已设置）
     SDL_SetRenderDrawColor(t->renderer, 0, 0, 0, 255);
-    SDL_Rect area = { px, py, TETRIS_WIDTH * cell_size, TETRIS_HEIGHT * cell_size };
+    const TetrisCore* core = &t->core;
+    SDL_Rect area = { px, py, core->width * cell_size, core->height * cell_size };
     SDL_RenderFillRect(t->renderer, &area);
 
     // 游戏结束时渲染结束画面
-    if (t->game_over) {
+    if (core->game_over) {
         // 半透明遮罩
         SDL_SetRenderDrawColor(t->renderer, 0, 0, 0, 180);
         SDL_RenderFillRect(t->renderer, &area);
 
         // "GAME OVER" 文字
-        int w = TETRIS_WIDTH * cell_size;
+        int w = core->width * cell_size;
         int center_x = px + w / 2;
-        int center_y = py + (TETRIS_HEIGHT * cell_size) / 2;
+        int center_y = py + (core->height * cell_size) / 2;
 
         const char* game_over_text = "GAME OVER";
         int text_x = center_x - (6 * (cell_size/3) * (int)strlen(game_over_text) / 2);
@@ -656,42 +537,56 @@ void tetris_render(Tetris* t, int px, int py, int cell_size) {
     SDL_Rect border = area;
     SDL_RenderDrawRect(t->renderer, &border);
 
-    // 绘制已放置的方块
-    for (int y = 0; y < TETRIS_HEIGHT; y++) {
-        for (int x = 0; x < TETRIS_WIDTH; x++) {
-            uint8_t val = t->grid[y][x];
-            if (val) {
-                // 获取方块颜色索引
-                int idx = (int)val - 1;
-                if (idx < 0) idx = 0;
-                if (idx > 6) idx = 6;
-                SDL_Color c = tetromino_colors[idx];
-                SDL_SetRenderDrawColor(t->renderer, c.r, c.g, c.b, c.a);
-                SDL_Rect r = { px + x * cell_size, py + y * cell_size, cell_size, cell_size };
-                SDL_RenderFillRect(t->renderer, &r);
-            }
+    // 绘制已放置的方块：从最高列顶开始逐行，只遍历位棋盘中置位的格子（开销与已占用格数成正比）
+    for (int y = core->height - core->stats.max_height; y < core->height; y++) {
+        const uint8_t* line = core->grid + (size_t)y * (size_t)core->width;
+        for (uint64_t m = core->rows[y]; m; m &= m - 1) {
+            int x = tetris_lowest_bit(m);
+            // 获取方块颜色索引
+            int idx = (int)line[x] - 1;
+            if (idx < 0) idx = 0;
+            if (idx > 6) idx = 6;
+            SDL_Color c = tetromino_colors[idx];
+            SDL_SetRenderDrawColor(t->renderer, c.r, c.g, c.b, c.a);
+            SDL_Rect r = { px + x * cell_size, py + y * cell_size, cell_size, cell_size };
+            SDL_RenderFillRect(t->renderer, &r);
         }
     }
 
-    // 绘制当前下落方块
-    if (t->current_id != TET_NONE) {
-        uint16_t shape = tetromino_shapes[t->current_id][t->current_rot & 3];
-        for (int ry = 0; ry < 4; ry++) {
-            for (int rx = 0; rx < 4; rx++) {
-                if (shape_cell(shape, rx, ry)) {
-                    int gx = t->current_x + rx;
-                    int gy = t->current_y + ry;
-                    // 确保在有效边界内
-                    if (gx >= 0 && gx < TETRIS_WIDTH && gy >= 0 && gy < TETRIS_HEIGHT) {
-                        SDL_Color c = tetromino_colors[t->current_id];
-                        // 下落方块使用稍亮的颜色
-                        SDL_SetRenderDrawColor(t->renderer, (Uint8)min(255, c.r + 40), (Uint8)min(255, c.g + 40), (Uint8)min(255, c.b + 40), c.a);
-                        SDL_Rect r = { px + gx * cell_size, py + gy * cell_size, cell_size, cell_size };
-                        SDL_RenderFillRect(t->renderer, &r);
-                    }
+    // 绘制当前下落方块（越界位置不绘制）
+    if (core->current_id != TET_NONE
+        && tetris_piece_in_board(core->current_id, core->current_rot, core->current_x, core->current_y, core->width, core->height)) {
+        TetrominoId id = core->current_id;
+        const TetrisPieceBox* b = &tetris_piece_boxes[id][core->current_rot & 3];
+        SDL_Color c = tetromino_colors[id];
+        // 影子方块：硬降后的落点，只画轮廓（落点由列高度表查得）
+        int ghost_y = tetris_core_ghost_y(core);
+        if (ghost_y != core->current_y) {
+            SDL_SetRenderDrawColor(t->renderer, c.r, c.g, c.b, c.a);
+            for (int ry = b->min_y; ry <= b->max_y; ry++) {
+                int gy = ghost_y + ry;
+                for (uint64_t m = tetris_piece_row(id, core->current_rot, core->current_x, ry); m; m &= m - 1) {
+                    SDL_Rect r = { px + tetris_lowest_bit(m) * cell_size + 1, py + gy * cell_size + 1, cell_size - 2, cell_size - 2 };
+                    SDL_RenderDrawRect(t->renderer, &r);
                 }
             }
         }
+        // 插值：方块下方有空间时，按已累计的下落量与距下一步的比例向下偏移（不超过一行）
+        int offset = 0;
+        if (ghost_y > core->current_y && core->gravity < TETRIS_GRAVITY_ONE) {
+            double fall = ((double)core->gravity_acc + (double)t->render_alpha * core->gravity * TETRIS_STEP_TICKS) / TETRIS_GRAVITY_ONE;
+            if (fall > 1.0) fall = 1.0;
+            offset = (int)(fall * (cell_size - 1));
+        }
+        // 下落方块使用稍亮的颜色
+        SDL_SetRenderDrawColor(t->renderer, (Uint8)min(255, c.r + 40), (Uint8)min(255, c.g + 40), (Uint8)min(255, c.b + 40), c.a);
+        for (int ry = b->min_y; ry <= b->max_y; ry++) {
+            int gy = core->current_y + ry;
+            for (uint64_t m = tetris_piece_row(id, core->current_rot, core->current_x, ry); m; m &= m - 1) {
+                SDL_Rect r = { px + tetris_lowest_bit(m) * cell_size, py + gy * cell_size + offset, cell_size, cell_size };
+                SDL_RenderFillRect(t->renderer, &r);
+            }
+        }
     }
     // 像素HUD已移除；侧边栏（TTF）提供分数/等级显示
     // HUD消息在其他地方绘制（TTF侧边栏）；传统像素HUD已移除
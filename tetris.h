@@ -3,50 +3,47 @@
 
 #include <stdint.h>
 #include <SDL.h>
-
-// 俄罗斯方块游戏网格尺寸定义
-#define TETRIS_WIDTH 10   // 游戏区域宽度（列数）
-#define TETRIS_HEIGHT 20  // 游戏区域高度（行数）
-
-// 俄罗斯方块类型枚举（0-6）
-// TET_NONE用于表示没有方块
-typedef enum {
-    TET_I,      // I形方块（条形）
-    TET_O,      // O形方块（正方形）
-    TET_T,      // T形方块
-    TET_S,      // S形方块
-    TET_Z,      // Z形方块
-    TET_J,      // J形方块
-    TET_L,      // L形方块
-    TET_NONE = 255  // 无方块标识
-} TetrominoId;
-
-// 俄罗斯方块游戏状态结构体
+#include "tetris_core.h"
+#include "tetris_replay.h"
+#include "tetris_history.h"
+#include "tetris_latency.h"
+
+// 固定步长模拟：每步TETRIS_STEP_TICKS个tick（250Hz，步长为整数毫秒，与规则核心的1 tick = 1 ms对齐）
+#define TETRIS_STEP_TICKS 4
+// 一帧最多追赶的模拟时间（毫秒），超出部分直接丢弃，避免卡顿后连续追赶
+#define TETRIS_MAX_CATCHUP_MS 250
+// 输入队列容量（2的幂）
+#define TETRIS_INPUT_QUEUE_SIZE 64
+
+// 排队的按键动作：在模拟时钟到达time_ms所在的步时执行
 typedef struct {
-    // 游戏网格：0表示空，>0表示已填充（颜色ID）
-    uint8_t grid[TETRIS_HEIGHT][TETRIS_WIDTH];
-    // 方块袋系统（7种方块的随机序列）
-    TetrominoId bag[7];
-    int bag_index;
-
-    // 当前下落方块状态
-    TetrominoId current_id;  // 当前方块类型
-    int current_rot;         // 当前旋转状态（0-3）
-    int current_x, current_y; // 当前方块原点位置
+    double time_ms;
+    int action;
+    int pressed;   // 1=按下，0=松开
+} TetrisQueuedInput;
 
-    // 时间控制系统
-    uint32_t drop_interval_ms;      // 当前下落间隔（毫秒）
-    uint32_t last_drop_time;        // 上次下落时间
-    uint32_t base_drop_interval_ms; // 基础下落间隔（应用速度倍率前）
-    float speed_multiplier;         // 速度倍率（0.5-2.0）
-
-    // 游戏统计数据
-    int score;         // 当前分数
-    int level;         // 当前等级
-    int lines_cleared; // 已消行数
-
-    // 游戏状态标志
-    int game_over;     // 游戏结束标志（1=已结束）
+// 俄罗斯方块前端状态结构体（规则核心 + 渲染/HUD）
+typedef struct {
+    // 规则核心（棋盘、方块袋、当前方块、分数等级、下落计时）
+    TetrisCore core;
+    uint32_t last_drop_time;   // 上次推进核心计时的时间（毫秒）
+    // 录制中的回放（NULL表示未录制）：tick推进、动作、速度变化与重新开始都会写入
+    TetrisReplay* recorder;
+    // 撤销/回退历史（每次锁定后录入快照，由tetris_update与tetris_perform_action维护）
+    TetrisHistory history;
+    // 固定步长模拟时钟（毫秒，与SDL事件时间戳同一时间轴）与按时间戳排队的输入
+    double sim_ms;
+    float render_alpha;        // 距下一步的比例（0-1），渲染时用于插值下落方块
+    TetrisQueuedInput inputs[TETRIS_INPUT_QUEUE_SIZE];
+    uint32_t input_head, input_tail;
+    // 自动重复（在固定步内推进，不依赖系统按键重复）
+    int das_ms, arr_ms;
+    uint32_t held;             // 按住的动作位掩码（1 << action）
+    int shift_action;          // 正在重复的水平移动动作（后按下的方向优先），无则为0
+    int shift_timer;           // 距下一次水平重复的毫秒数
+    int drop_timer;            // 距下一次软降重复的毫秒数
+    // 输入到画面的延迟统计（按下的动作在执行时采样，上屏由主循环标记）
+    TetrisLatency latency;
 
     // 渲染相关
     SDL_Renderer* renderer;  // SDL渲染器（用于渲染辅助函数）
@@ -58,18 +55,35 @@ typedef struct {
 } Tetris;
 
 // 初始化俄罗斯方块游戏状态，传入SDL渲染器用于渲染
-void tetris_init(Tetris* t, SDL_Renderer* renderer);
+// 返回：0=成功，-1=参数无效，-2=棋盘内存分配失败（此时游戏不可用，调用者应退出）
+int tetris_init(Tetris* t, SDL_Renderer* renderer);
 
 // 已移除：tetris_handle_key函数声明（已由keymap系统替代）
 
 // 推进游戏状态（检查定时器），定期调用此函数
 void tetris_update(Tetris* t, uint32_t now_ms);
+// 按事件时间戳排队一个按键动作（队列满时立即执行）
+// 左右移动与软降按下后持续按DAS/ARR重复，直到排队对应的松开
+void tetris_queue_action(Tetris* t, int action, double time_ms);
+void tetris_queue_release(Tetris* t, int action, double time_ms);
+// 设置自动重复的DAS/ARR（毫秒）
+void tetris_set_auto_repeat(Tetris* t, int das_ms, int arr_ms);
+// 以固定步长把模拟推进到now_ms：每步先执行时间戳落在该步之前的排队动作，再推进TETRIS_STEP_TICKS个tick
+// 返回执行的步数，并更新render_alpha
+int tetris_advance(Tetris* t, double now_ms);
+// 模拟时钟跟随now_ms，丢弃排队动作并清除按住状态（暂停或离开游戏界面时每帧调用，恢复后不会补偿暂停时间）
+void tetris_sync_clock(Tetris* t, double now_ms);
+// 处理规则核心产生的事件（音效、HUD提示），每帧在推进与动作之后调用一次
+void tetris_process_events(Tetris* t);
 
 // 渲染当前游戏状态（使用SDL渲染器）
 void tetris_render(Tetris* t, int px, int py, int cell_size);
 
 // 重置游戏状态
 void tetris_reset(Tetris* t);
+// 改变棋盘尺寸（TETRIS_MIN_WIDTH..TETRIS_MAX_WIDTH × TETRIS_MIN_HEIGHT..TETRIS_MAX_HEIGHT）并以新的随机种子开始新的一局
+// 录制中时先结束录制；非标准尺寸不支持撤销与机器人。返回值同tetris_core_resize
+int tetris_set_board_size(Tetris* t, int width, int height);
 
 // 速度控制接口
 void tetris_set_speed_multiplier(Tetris* t, float mul);
@@ -85,5 +99,10 @@ void tetris_draw_text(Tetris* t, int x, int y, const char* text, int cell_size);
 void tetris_render_preview(Tetris* t, TetrominoId id, int px, int py, int cell_size);
 // 执行高级动作（来自按键映射系统）
 void tetris_perform_action(Tetris* t, int action);
+// 结束录制：记录当前状态作为回放终点并解除录制（读档或加载关卡会直接修改棋盘，无法写入回放）
+void tetris_stop_recording(Tetris* t);
+// 撤销/重做：delta为负时回退到之前方块开始下落时的状态，为正时前进；返回实际移动的步数
+// 还原会直接修改棋盘，录制中时先结束录制
+int tetris_rewind(Tetris* t, int delta);
 
 #endif // TETRIS_H
@@ -0,0 +1,99 @@
+#include "tetris_audio.h"
+#include <string.h>
+#include <math.h>
+
+#define TETRIS_TWO_PI 6.28318531f
+
+// 音频回调（运行在SDL音频线程）
+// 功能点：
+// - 取出全部新音调放入空闲声部（没有空闲声部时丢弃）
+// - 各声部从自己的开始时刻起叠加正弦波，播放完毕后释放
+// - 推进采样时钟play_pos，供前端为新音调打时间戳
+static void tetris_audio_callback(void* userdata, Uint8* stream, int len) {
+    TetrisAudio* a = (TetrisAudio*)userdata;
+    float* out = (float*)stream;
+    int count = len / (int)sizeof(float);
+    uint32_t pos = (uint32_t)SDL_AtomicGet(&a->play_pos);
+    int tail = SDL_AtomicGet(&a->tail);
+    int head = SDL_AtomicGet(&a->head);
+    SDL_MemoryBarrierAcquire();
+    for (; tail != head; tail++) {
+        const TetrisTone* t = &a->ring[tail & (TETRIS_AUDIO_RING_SIZE - 1)];
+        for (int v = 0; v < TETRIS_AUDIO_VOICES; v++) {
+            if (a->voices[v].active) continue;
+            a->voices[v].tone = *t;
+            a->voices[v].phase = 0.0f;
+            a->voices[v].active = 1;
+            break;
+        }
+    }
+    SDL_AtomicSet(&a->tail, tail);
+
+    memset(out, 0, sizeof(float) * (size_t)count);
+    for (int v = 0; v < TETRIS_AUDIO_VOICES; v++) {
+        TetrisVoice* voice = &a->voices[v];
+        if (!voice->active) continue;
+        const TetrisTone* t = &voice->tone;
+        // 开始时刻在本缓冲区之后的声部本次不发声
+        int32_t first = (int32_t)(t->start - pos);
+        if (first >= count) continue;
+        int i = first > 0 ? first : 0;
+        for (; i < count; i++) {
+            uint32_t k = pos + (uint32_t)i - t->start;
+            if (k >= t->length) {
+                voice->active = 0;
+                break;
+            }
+            float env = 1.0f - (float)k / (float)t->length;  // 线性衰减
+            out[i] += t->volume * env * sinf(voice->phase);
+            voice->phase += t->step;
+            if (voice->phase >= TETRIS_TWO_PI) voice->phase -= TETRIS_TWO_PI;
+        }
+    }
+    SDL_AtomicSet(&a->play_pos, (int)(pos + (uint32_t)count));
+}
+
+// 打开回调式音频设备
+// 功能点：
+// - 44.1kHz，32位浮点，单声道，256采样的设备缓冲区（约5.8ms）
+// - 打开失败时静默继续（无声音）
+int tetris_audio_open(TetrisAudio* a) {
+    memset(a, 0, sizeof(*a));
+    SDL_AudioSpec want, have;
+    SDL_zero(want);
+    want.freq = 44100;
+    want.format = AUDIO_F32SYS;
+    want.channels = 1;
+    want.samples = 256;
+    want.callback = tetris_audio_callback;
+    want.userdata = a;
+    a->dev = SDL_OpenAudioDevice(NULL, 0, &want, &have, 0);
+    if (a->dev == 0) {
+        SDL_Log("SDL_OpenAudioDevice failed: %s", SDL_GetError());
+        return -1;
+    }
+    a->freq = have.freq;
+    a->latency_samples = have.samples;
+    SDL_PauseAudioDevice(a->dev, 0);
+    return 0;
+}
+
+void tetris_audio_close(TetrisAudio* a) {
+    if (a->dev) SDL_CloseAudioDevice(a->dev);
+    a->dev = 0;
+}
+
+// 前端写入音调（无锁、无分配）
+void tetris_audio_play(TetrisAudio* a, float freq_hz, int ms, float volume, int delay_ms) {
+    if (!a->dev || ms <= 0) return;
+    int head = SDL_AtomicGet(&a->head);
+    if (head - SDL_AtomicGet(&a->tail) >= TETRIS_AUDIO_RING_SIZE) return;
+    TetrisTone* t = &a->ring[head & (TETRIS_AUDIO_RING_SIZE - 1)];
+    uint32_t delay = delay_ms > 0 ? (uint32_t)((uint64_t)a->freq * (uint32_t)delay_ms / 1000) : 0;
+    t->start = (uint32_t)SDL_AtomicGet(&a->play_pos) + a->latency_samples + delay;
+    t->length = (uint32_t)((uint64_t)a->freq * (uint32_t)ms / 1000);
+    t->step = TETRIS_TWO_PI * freq_hz / (float)a->freq;
+    t->volume = volume;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&a->head, head + 1);
+}
@@ -0,0 +1,51 @@
+#ifndef TETRIS_AUDIO_H
+#define TETRIS_AUDIO_H
+
+#include <stdint.h>
+#include <SDL.h>
+
+// 音调环形缓冲区容量（必须为2的幂）
+#define TETRIS_AUDIO_RING_SIZE 64
+// 同时发声的音调数上限
+#define TETRIS_AUDIO_VOICES 8
+
+// 一个待播放的音调：从start（音频设备采样时钟）开始，正弦波 + 线性衰减包络
+typedef struct {
+    uint32_t start;
+    uint32_t length;   // 采样数
+    float step;        // 每个采样的相位增量（弧度）
+    float volume;
+} TetrisTone;
+
+// 回调中正在发声的音调
+typedef struct {
+    TetrisTone tone;
+    float phase;
+    int active;
+} TetrisVoice;
+
+// 俄罗斯方块音效（回调式SDL音频 + 无锁单生产者/单消费者环形缓冲区，与chip8_audio相同）
+// 前端只通过tetris_audio_play写入音调；音频回调取出音调并混合到空闲声部
+// 整个过程不分配内存、不加锁，音频线程慢也不会阻塞游戏
+typedef struct {
+    SDL_AudioDeviceID dev;
+    int freq;                    // 实际采样率
+    uint32_t latency_samples;    // 音调相对当前播放位置的延迟（一个设备缓冲区）
+
+    TetrisTone ring[TETRIS_AUDIO_RING_SIZE];
+    SDL_atomic_t head;           // 写入位置（仅前端修改）
+    SDL_atomic_t tail;           // 读取位置（仅音频回调修改）
+    SDL_atomic_t play_pos;       // 音频回调已输出的采样数（采样时钟）
+
+    // 音频回调私有状态
+    TetrisVoice voices[TETRIS_AUDIO_VOICES];
+} TetrisAudio;
+
+// 打开音频设备并启动回调，失败返回-1（此时tetris_audio_play为空操作）
+int tetris_audio_open(TetrisAudio* a);
+void tetris_audio_close(TetrisAudio* a);
+
+// 播放音调：delay_ms毫秒后开始，持续ms毫秒（环满时丢弃）
+void tetris_audio_play(TetrisAudio* a, float freq_hz, int ms, float volume, int delay_ms);
+
+#endif // TETRIS_AUDIO_H
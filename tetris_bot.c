@@ -0,0 +1,380 @@
+#include "tetris_bot.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 死局评估值（新方块无法生成）
+#define BOT_DEAD (-1.0e9f)
+// 每评估多少个节点检查一次截止时间
+#define BOT_CLOCK_INTERVAL 64
+
+void tetris_bot_default_config(TetrisBotConfig* cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->threads = 0;
+    cfg->depth = 2;
+    cfg->budget_ms = 1.0;
+    cfg->tt_mb = 4;
+    tetris_eval_default_weights(&cfg->weights);
+}
+
+// 单线程搜索状态
+typedef struct {
+    TetrisBotWorker* w;
+    int aborted;
+    int clock;
+} BotSearch;
+
+// 距截止时间检查（每BOT_CLOCK_INTERVAL个节点读一次计数器）
+static int out_of_time(BotSearch* s) {
+    if (s->aborted) return 1;
+    if (++s->clock < BOT_CLOCK_INTERVAL) return 0;
+    s->clock = 0;
+    if (SDL_GetPerformanceCounter() >= s->w->bot->deadline) s->aborted = 1;
+    return s->aborted;
+}
+
+static float search(BotSearch* s, const uint16_t* rows, uint64_t hash, int level);
+
+// 在rows上把第level个方块依次放到pl[0..n)，返回最佳值（消行奖励 + 子节点值）
+// 子节点是叶子时凑满TETRIS_EVAL_BATCH个棋盘批量评估，否则逐个递归搜索
+static float best_child(BotSearch* s, const uint16_t* rows, uint64_t hash, int level,
+                        const TetrisPlacement* pl, int n) {
+    TetrisBot* bot = s->w->bot;
+    const TetrisWeights* w = &bot->cfg.weights;
+    TetrominoId id = bot->pieces[level];
+    float best = BOT_DEAD;
+    if (level + 1 < bot->depth) {
+        for (int i = 0; i < n && !out_of_time(s); i++) {
+            uint16_t next[TETRIS_HEIGHT];
+            uint64_t next_hash = hash;
+            memcpy(next, rows, sizeof(next));
+            int lines = tetris_movegen_apply(next, &next_hash, id, &pl[i]);
+            float v = tetris_eval_clear_reward(lines, w) + search(s, next, next_hash, level + 1);
+            if (v > best) best = v;
+        }
+        return best;
+    }
+    TetrisEvalBatch batch;
+    float reward[TETRIS_EVAL_BATCH], value[TETRIS_EVAL_BATCH];
+    uint8_t dead[TETRIS_EVAL_BATCH];
+    int k = 0;
+    for (int i = 0; i < n && !out_of_time(s); i++) {
+        uint16_t next[TETRIS_HEIGHT];
+        memcpy(next, rows, sizeof(next));
+        reward[k] = tetris_eval_clear_reward(tetris_movegen_apply(next, NULL, id, &pl[i]), w);
+        dead[k] = (uint8_t)tetris_eval_spawn_blocked(next);
+        tetris_eval_batch_set(&batch, k, next);
+        if (++k < TETRIS_EVAL_BATCH && i + 1 < n) continue;
+        tetris_eval_batch(&batch, k, w, value);
+        for (int j = 0; j < k; j++) {
+            float v = reward[j] + (dead[j] ? BOT_DEAD : value[j]);
+            if (v > best) best = v;
+        }
+        s->w->nodes += (uint64_t)k;
+        k = 0;
+    }
+    return best;
+}
+
+// 深度优先：第level个方块（level < depth）在rows上的最佳值（含之后各层的消行奖励）
+// 功能点：
+// - 内部节点键 = 棋盘哈希 ^ 剩余方块序列键，先查置换表
+// - 叶子不查表：批量评估一个棋盘只需十几纳秒，比一次未命中缓存的查表更便宜
+// - 超时中断的节点值不完整，不写入置换表
+static float search(BotSearch* s, const uint16_t* rows, uint64_t hash, int level) {
+    TetrisBot* bot = s->w->bot;
+    uint64_t key = hash ^ bot->seq_keys[level];
+    float best;
+    s->w->tt_probes++;
+    if (tetris_tt_probe(&bot->tt, key, &best)) {
+        s->w->tt_hits++;
+        return best;
+    }
+    TetrisMoveGen g;
+    TetrisPlacement pl[TETRIS_MAX_PLACEMENTS];
+    int n = tetris_movegen_generate(&g, rows, bot->pieces[level], TETRIS_SPAWN_X, 0, TETRIS_SPAWN_Y,
+                                    pl, TETRIS_MAX_PLACEMENTS);
+    best = best_child(s, rows, hash, level, pl, n);
+    if (!s->aborted) tetris_tt_store(&bot->tt, key, best);
+    return best;
+}
+
+// 从自己的队列底部取任务
+static int deque_pop(TetrisBotDeque* d, int* item) {
+    int ok = 0;
+    SDL_AtomicLock(&d->lock);
+    if (d->bottom > d->top) {
+        *item = d->items[--d->bottom];
+        ok = 1;
+    }
+    SDL_AtomicUnlock(&d->lock);
+    return ok;
+}
+
+// 从其他线程队列顶部窃取任务
+static int deque_steal(TetrisBotDeque* d, int* item) {
+    int ok = 0;
+    SDL_AtomicLock(&d->lock);
+    if (d->bottom > d->top) {
+        *item = d->items[d->top++];
+        ok = 1;
+    }
+    SDL_AtomicUnlock(&d->lock);
+    return ok;
+}
+
+// 执行一轮搜索的任务，直到所有队列为空或超时
+static void run_tasks(TetrisBotWorker* w) {
+    TetrisBot* bot = w->bot;
+    BotSearch s;
+    s.w = w;
+    s.aborted = 0;
+    s.clock = 0;
+    for (;;) {
+        if (SDL_GetPerformanceCounter() >= bot->deadline) return;
+        int t;
+        if (!deque_pop(&w->deque, &t)) {
+            int found = 0;
+            for (int k = 1; k < bot->num_workers && !found; k++) {
+                TetrisBotWorker* victim = &bot->workers[(w->index + k) % bot->num_workers];
+                found = deque_steal(&victim->deque, &t);
+            }
+            if (!found) return;
+            w->steals++;
+        }
+        const TetrisBotTask* task = &bot->tasks[t];
+        const TetrisBotRoot* root = &bot->roots[task->root];
+        float v = best_child(&s, root->rows, root->hash, 1, bot->second + task->first, task->count);
+        if (s.aborted) return;
+        bot->task_values[t] = root->reward + v;
+        bot->task_done[t] = 1;
+    }
+}
+
+// 辅助线程：等待开始信号，执行任务，报告完成
+static int bot_thread(void* data) {
+    TetrisBotWorker* w = (TetrisBotWorker*)data;
+    TetrisBot* bot = w->bot;
+    for (;;) {
+        SDL_SemWait(bot->start);
+        if (SDL_AtomicGet(&bot->quit)) break;
+        run_tasks(w);
+        SDL_SemPost(bot->done);
+    }
+    return 0;
+}
+
+int tetris_bot_create(TetrisBot* bot, const TetrisBotConfig* cfg) {
+    memset(bot, 0, sizeof(*bot));
+    bot->cfg = *cfg;
+    if (bot->cfg.depth < 1) bot->cfg.depth = 1;
+    if (bot->cfg.depth > TETRIS_BOT_MAX_DEPTH) bot->cfg.depth = TETRIS_BOT_MAX_DEPTH;
+    int n = cfg->threads > 0 ? cfg->threads : SDL_GetCPUCount();
+    if (n < 1) n = 1;
+    if (n > TETRIS_BOT_MAX_THREADS) n = TETRIS_BOT_MAX_THREADS;
+    bot->num_workers = n;
+    bot->roots = (TetrisBotRoot*)malloc(sizeof(TetrisBotRoot) * TETRIS_MAX_PLACEMENTS);
+    bot->start = SDL_CreateSemaphore(0);
+    bot->done = SDL_CreateSemaphore(0);
+    int tt_rc = tetris_tt_create(&bot->tt, cfg->tt_mb > 0 ? (size_t)cfg->tt_mb << 20 : 0);
+    if (!bot->roots || !bot->start || !bot->done || tt_rc != 0) {
+        tetris_bot_destroy(bot);
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        bot->workers[i].bot = bot;
+        bot->workers[i].index = i;
+    }
+    // 0号工作者由调用线程担任
+    for (int i = 1; i < n; i++) {
+        bot->threads[i] = SDL_CreateThread(bot_thread, "tetris-bot", &bot->workers[i]);
+        if (!bot->threads[i]) {
+            bot->num_workers = i;
+            break;
+        }
+    }
+    return 0;
+}
+
+void tetris_bot_destroy(TetrisBot* bot) {
+    SDL_AtomicSet(&bot->quit, 1);
+    for (int i = 1; i < bot->num_workers; i++) {
+        if (bot->threads[i]) SDL_SemPost(bot->start);
+    }
+    for (int i = 1; i < bot->num_workers; i++) {
+        if (bot->threads[i]) SDL_WaitThread(bot->threads[i], NULL);
+    }
+    if (bot->start) SDL_DestroySemaphore(bot->start);
+    if (bot->done) SDL_DestroySemaphore(bot->done);
+    free(bot->roots);
+    free(bot->tasks);
+    free(bot->second);
+    free(bot->task_values);
+    free(bot->task_done);
+    free(bot->deque_items);
+    tetris_tt_destroy(&bot->tt);
+    memset(bot, 0, sizeof(*bot));
+}
+
+// 保证任务与第二层落点数组容量
+static int reserve_tasks(TetrisBot* bot, int need) {
+    if (need <= bot->task_cap) return 0;
+    int cap = bot->task_cap ? bot->task_cap : 1024;
+    while (cap < need) cap *= 2;
+    TetrisBotTask* t = (TetrisBotTask*)realloc(bot->tasks, sizeof(TetrisBotTask) * (size_t)cap);
+    if (t) bot->tasks = t;
+    TetrisPlacement* p = (TetrisPlacement*)realloc(bot->second, sizeof(TetrisPlacement) * (size_t)cap);
+    if (p) bot->second = p;
+    float* v = (float*)realloc(bot->task_values, sizeof(float) * (size_t)cap);
+    if (v) bot->task_values = v;
+    uint8_t* d = (uint8_t*)realloc(bot->task_done, (size_t)cap);
+    if (d) bot->task_done = d;
+    int* q = (int*)realloc(bot->deque_items, sizeof(int) * (size_t)cap);
+    if (q) bot->deque_items = q;
+    if (!t || !p || !v || !d || !q) return -1;
+    bot->task_cap = cap;
+    return 0;
+}
+
+// 第一层候选按浅层评估值降序（好的候选先被搜索）
+static int compare_roots(const void* a, const void* b) {
+    float x = ((const TetrisBotRoot*)a)->shallow, y = ((const TetrisBotRoot*)b)->shallow;
+    return (x < y) - (x > y);
+}
+
+// 决策
+// 功能点：
+// - 可用深度 = min(配置深度, 1 + 当前袋子里剩余的预览方块数)
+// - 第一层在调用线程展开并按浅层评估排序；第二层落点切成任务（深度2时每批TETRIS_EVAL_BATCH个）
+// - 任务按候选顺序切块放入各线程队列，空闲线程从其他队列窃取
+// - 超时后只比较全部任务都已完成的候选；没有则退回浅层评估
+int tetris_bot_decide(TetrisBot* bot, const TetrisCore* core, TetrisPlacement* out, TetrisPath* path) {
+    Uint64 t0 = SDL_GetPerformanceCounter();
+    Uint64 freq = SDL_GetPerformanceFrequency();
+    memset(&bot->stats, 0, sizeof(bot->stats));
+    uint16_t rows[TETRIS_HEIGHT];
+    if (core->game_over || core->current_id > TET_L) return -1;
+    // 搜索按标准棋盘的16位行进行，其他尺寸不支持
+    if (tetris_core_standard_rows(core, rows) != 0) return -3;
+    bot->deadline = t0 + (Uint64)(bot->cfg.budget_ms * (double)freq / 1000.0);
+
+    // 已知方块序列
+    bot->pieces[0] = core->current_id;
+    bot->depth = 1;
+    while (bot->depth < bot->cfg.depth && core->bag_index + bot->depth - 1 < 7) {
+        bot->pieces[bot->depth] = core->bag[core->bag_index + bot->depth - 1];
+        bot->depth++;
+    }
+    bot->stats.depth = bot->depth;
+    for (int level = 0; level <= bot->depth; level++) {
+        bot->seq_keys[level] = tetris_tt_sequence_key(bot->pieces + level, bot->depth - level);
+    }
+
+    // 第一层
+    TetrisMoveGen g;
+    TetrisPlacement pl[TETRIS_MAX_PLACEMENTS];
+    int n = tetris_movegen_generate(&g, rows, core->current_id, core->current_x, core->current_rot,
+                                    core->current_y, pl, TETRIS_MAX_PLACEMENTS);
+    if (n == 0) return -2;
+    for (int i = 0; i < bot->num_workers; i++) {
+        bot->workers[i].nodes = 0;
+        bot->workers[i].steals = 0;
+        bot->workers[i].tt_probes = 0;
+        bot->workers[i].tt_hits = 0;
+    }
+    for (int i = 0; i < n; i++) {
+        TetrisBotRoot* r = &bot->roots[i];
+        r->placement = pl[i];
+        memcpy(r->rows, rows, sizeof(r->rows));
+        r->hash = core->hash;
+        int lines = tetris_movegen_apply(r->rows, &r->hash, core->current_id, &pl[i]);
+        r->reward = tetris_eval_clear_reward(lines, &bot->cfg.weights);
+    }
+    // 浅层评估：全部候选棋盘分批评估
+    for (int i = 0; i < n; i += TETRIS_EVAL_BATCH) {
+        int k = n - i < TETRIS_EVAL_BATCH ? n - i : TETRIS_EVAL_BATCH;
+        TetrisEvalBatch batch;
+        float value[TETRIS_EVAL_BATCH];
+        for (int j = 0; j < k; j++) tetris_eval_batch_set(&batch, j, bot->roots[i + j].rows);
+        tetris_eval_batch(&batch, k, &bot->cfg.weights, value);
+        for (int j = 0; j < k; j++) {
+            TetrisBotRoot* r = &bot->roots[i + j];
+            r->shallow = r->reward + (tetris_eval_spawn_blocked(r->rows) ? BOT_DEAD : value[j]);
+        }
+    }
+    bot->workers[0].nodes += (uint64_t)n;
+    bot->num_roots = n;
+    qsort(bot->roots, (size_t)n, sizeof(TetrisBotRoot), compare_roots);
+    int best = 0;
+    float best_value = bot->roots[0].shallow;
+
+    if (bot->depth >= 2) {
+        // 第二层任务：叶子层按批切分，更深时每个落点一个任务
+        int chunk = bot->depth == 2 ? TETRIS_EVAL_BATCH : 1;
+        bot->num_tasks = 0;
+        bot->num_second = 0;
+        for (int i = 0; i < n; i++) {
+            TetrisMoveGen g2;
+            if (reserve_tasks(bot, bot->num_second + TETRIS_MAX_PLACEMENTS) != 0) break;
+            TetrisPlacement* pl2 = bot->second + bot->num_second;
+            int m = tetris_movegen_generate(&g2, bot->roots[i].rows, bot->pieces[1], TETRIS_SPAWN_X, 0,
+                                            TETRIS_SPAWN_Y, pl2, TETRIS_MAX_PLACEMENTS);
+            for (int k = 0; k < m; k += chunk) {
+                TetrisBotTask* t = &bot->tasks[bot->num_tasks];
+                t->root = i;
+                t->first = bot->num_second + k;
+                t->count = m - k < chunk ? m - k : chunk;
+                bot->task_done[bot->num_tasks] = 0;
+                bot->num_tasks++;
+            }
+            bot->num_second += m;
+        }
+        // 切块分配：每个线程一段连续任务，倒序存放使队列底部是排序靠前的任务
+        int nt = bot->num_tasks, nw = bot->num_workers;
+        for (int w = 0; w < nw; w++) {
+            int lo = (int)((long long)nt * w / nw), hi = (int)((long long)nt * (w + 1) / nw);
+            TetrisBotDeque* d = &bot->workers[w].deque;
+            d->items = bot->deque_items + lo;
+            d->top = 0;
+            d->bottom = hi - lo;
+            for (int k = 0; k < hi - lo; k++) d->items[k] = hi - 1 - k;
+        }
+        for (int w = 1; w < nw; w++) SDL_SemPost(bot->start);
+        run_tasks(&bot->workers[0]);
+        for (int w = 1; w < nw; w++) SDL_SemWait(bot->done);
+
+        // 汇总：候选值 = 其全部任务的最大值；有任务未完成的候选不参与比较
+        int found = 0;
+        int ti = 0;
+        for (int i = 0; i < n; i++) {
+            float v = BOT_DEAD;
+            int complete = 1;
+            for (; ti < nt && bot->tasks[ti].root == i; ti++) {
+                if (!bot->task_done[ti]) complete = 0;
+                else if (bot->task_values[ti] > v) v = bot->task_values[ti];
+                bot->stats.tasks_done += bot->task_done[ti];
+            }
+            if (complete && (!found || v > best_value)) {
+                best = i;
+                best_value = v;
+                found = 1;
+            }
+        }
+        if (!found) {
+            best = 0;
+            best_value = bot->roots[0].shallow;
+        }
+        bot->stats.tasks = nt;
+    }
+
+    for (int i = 0; i < bot->num_workers; i++) {
+        bot->stats.nodes += bot->workers[i].nodes;
+        bot->stats.steals += bot->workers[i].steals;
+        bot->stats.tt_probes += bot->workers[i].tt_probes;
+        bot->stats.tt_hits += bot->workers[i].tt_hits;
+    }
+    *out = bot->roots[best].placement;
+    bot->stats.value = best_value;
+    int rc = path ? tetris_movegen_path(&g, out, path) : 0;
+    bot->stats.ms = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / (double)freq;
+    return rc;
+}
@@ -0,0 +1,110 @@
+#ifndef TETRIS_BOT_H
+#define TETRIS_BOT_H
+
+#include <stdint.h>
+#include <SDL.h>
+#include "tetris_core.h"
+#include "tetris_movegen.h"
+#include "tetris_eval.h"
+#include "tetris_tt.h"
+
+// 俄罗斯方块机器人：对当前方块与已知预览方块做前瞻搜索
+// - 每层用落点生成器枚举全部落点（含塞入），叶子用启发式权重评估
+// - 第二层起的子树作为任务分给常驻线程池，线程间以双端队列互相窃取任务
+// - 每个方块的决策受时间预算约束，超时后只在已完整搜索的候选中选择
+// - 已完整搜索的内部节点存入共享置换表，不同落点组合到达的相同棋盘直接复用，表跨方块保留
+
+#define TETRIS_BOT_MAX_DEPTH 4
+#define TETRIS_BOT_MAX_THREADS 64
+
+typedef struct {
+    int threads;            // 工作线程数（<=0表示使用全部CPU核心）
+    int depth;              // 搜索深度：1=只看当前方块，每加1多看一个预览方块
+    double budget_ms;       // 每个方块的决策时间预算（毫秒）
+    TetrisWeights weights;  // 评估权重
+    int tt_mb;              // 置换表大小（MB），0表示不使用置换表
+} TetrisBotConfig;
+
+typedef struct {
+    uint64_t nodes;         // 评估的棋盘数
+    int tasks;              // 本次决策生成的任务数
+    int tasks_done;         // 截止前完成的任务数
+    int steals;             // 跨线程窃取的任务数
+    int depth;              // 实际搜索深度（受预览方块数量限制）
+    float value;            // 所选落点的评估值
+    double ms;              // 决策耗时
+    uint64_t tt_probes;     // 置换表查找次数
+    uint64_t tt_hits;       // 置换表命中次数（命中率 = tt_hits / tt_probes）
+} TetrisBotStats;
+
+// 一个任务：第一层落点root之后，第二个方块放在second[first..first+count)的各子树
+// 深度2时子节点都是叶子，一个任务含一批（TETRIS_EVAL_BATCH个）落点以便批量评估；更深时每个落点一个任务
+typedef struct {
+    int root;
+    int first, count;
+} TetrisBotTask;
+
+// 第一层候选
+typedef struct {
+    TetrisPlacement placement;
+    uint16_t rows[TETRIS_HEIGHT];  // 放置并消行后的棋盘
+    uint64_t hash;                 // rows的棋盘行哈希（与TetrisCore.hash同一规则）
+    float reward;                  // 消行奖励
+    float shallow;                 // 只看一层的评估值
+} TetrisBotRoot;
+
+// 任务双端队列：所属线程从bottom端取，其他线程从top端窃取
+typedef struct {
+    SDL_SpinLock lock;
+    int top, bottom;
+    int* items;
+} TetrisBotDeque;
+
+struct TetrisBot;
+
+typedef struct {
+    struct TetrisBot* bot;
+    int index;
+    TetrisBotDeque deque;
+    uint64_t nodes;
+    int steals;
+    uint64_t tt_probes, tt_hits;
+} TetrisBotWorker;
+
+typedef struct TetrisBot {
+    TetrisBotConfig cfg;
+    int num_workers;
+    SDL_Thread* threads[TETRIS_BOT_MAX_THREADS];
+    TetrisBotWorker workers[TETRIS_BOT_MAX_THREADS];
+    SDL_sem* start;         // 通知辅助线程开始一轮搜索
+    SDL_sem* done;          // 辅助线程完成一轮搜索
+    SDL_atomic_t quit;
+
+    // 当前决策的共享数据（一轮搜索期间只读，结果按任务分槽写入）
+    TetrominoId pieces[TETRIS_BOT_MAX_DEPTH];
+    int depth;
+    uint64_t seq_keys[TETRIS_BOT_MAX_DEPTH + 1];  // 第level层起剩余方块序列的置换表键
+    Uint64 deadline;
+    TetrisBotRoot* roots;
+    int num_roots;
+    TetrisBotTask* tasks;
+    TetrisPlacement* second;  // 全部候选的第二层落点（按候选顺序连续存放）
+    int num_second;
+    float* task_values;
+    uint8_t* task_done;
+    int num_tasks, task_cap;  // task_cap同时是second的容量（任务数不超过落点数）
+    int* deque_items;       // 各线程队列的存储（共num_tasks个）
+    TetrisTT tt;            // 共享置换表（跨决策保留）
+
+    TetrisBotStats stats;
+} TetrisBot;
+
+// 默认配置：全部核心、深度2、每块1毫秒、默认权重、4MB置换表
+void tetris_bot_default_config(TetrisBotConfig* cfg);
+// 创建机器人并启动线程池，成功返回0
+int tetris_bot_create(TetrisBot* bot, const TetrisBotConfig* cfg);
+void tetris_bot_destroy(TetrisBot* bot);
+// 为core的当前方块选择落点，输出落点和输入路径；无合法落点或棋盘不是标准10×20时返回非0
+int tetris_bot_decide(TetrisBot* bot, const TetrisCore* core, TetrisPlacement* out, TetrisPath* path);
+
+#endif // TETRIS_BOT_H
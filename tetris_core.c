@@ -0,0 +1,547 @@
+#include "tetris_core.h"
+#include <stdlib.h>
+#include <string.h>
+#include "tetris_pieces.h"
+
+// 写入一个事件（环满时丢弃并计数，模拟不等待消费者）
+static void emit(TetrisCore* c, TetrisEventType type, int value) {
+    if (c->event_head - c->event_tail >= TETRIS_EVENT_RING_SIZE) {
+        c->events_dropped++;
+        return;
+    }
+    TetrisEvent* e = &c->events[c->event_head & (TETRIS_EVENT_RING_SIZE - 1)];
+    e->type = type;
+    e->value = value;
+    c->event_head++;
+}
+
+int tetris_core_poll_event(TetrisCore* c, TetrisEvent* ev) {
+    if (c->event_tail == c->event_head) return 0;
+    *ev = c->events[c->event_tail & (TETRIS_EVENT_RING_SIZE - 1)];
+    c->event_tail++;
+    return 1;
+}
+
+void tetris_core_clear_events(TetrisCore* c) {
+    c->event_tail = c->event_head;
+}
+
+static uint32_t rotl32(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+// xoshiro128**：4个32位字的状态，周期2^128-1
+static uint32_t next_random(uint32_t* s) {
+    uint32_t result = rotl32(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl32(s[3], 11);
+    return result;
+}
+
+uint32_t tetris_core_random(TetrisCore* c) {
+    return next_random(c->rng);
+}
+
+// 用splitmix32把种子展开为xoshiro状态（保证状态不全为0）
+static void seed_rng(TetrisCore* c, uint32_t seed) {
+    c->seed = seed;
+    uint32_t z = seed;
+    for (int i = 0; i < 4; i++) {
+        z += 0x9E3779B9u;
+        uint32_t x = z;
+        x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
+        x = (x ^ (x >> 13)) * 0xC2B2AE35u;
+        c->rng[i] = x ^ (x >> 16);
+    }
+    if (!(c->rng[0] | c->rng[1] | c->rng[2] | c->rng[3])) c->rng[0] = 1;
+}
+
+// 洗牌袋算法：生成随机方块序列
+// 功能点：
+// - 填充袋子数组（0-6对应7种方块）
+// - 使用Fisher-Yates洗牌算法，下标由本局随机数乘法映射到[0, i]（无取模偏差、无除法）
+// - 重置袋子索引为0
+static void fill_bag(uint32_t* rng, TetrominoId* bag) {
+    // 填充袋子数组（7种方块ID：0-6）
+    for (int i = 0; i < 7; i++) bag[i] = (TetrominoId)i;
+    // Fisher-Yates洗牌算法：从后往前随机交换位置
+    for (int i = 6; i > 0; i--) {
+        int j = (int)(((uint64_t)next_random(rng) * (uint32_t)(i + 1)) >> 32);
+        TetrominoId tmp = bag[i];
+        bag[i] = bag[j];
+        bag[j] = tmp;
+    }
+}
+
+static void shuffle_bag(TetrisCore* c) {
+    fill_bag(c->rng, c->bag);
+    c->bag_index = 0;
+}
+
+// 预览：先取当前袋子剩余的方块，之后的袋子用随机数状态的副本按同样方式洗牌得到
+void tetris_core_preview(const TetrisCore* c, TetrominoId* out, int n) {
+    uint32_t rng[4];
+    TetrominoId bag[7];
+    memcpy(rng, c->rng, sizeof(rng));
+    memcpy(bag, c->bag, sizeof(bag));
+    int index = c->bag_index;
+    for (int i = 0; i < n; i++) {
+        if (index >= 7) {
+            fill_bag(rng, bag);
+            index = 0;
+        }
+        out[i] = bag[index++];
+    }
+}
+
+// 碰撞检测函数
+// 功能点：
+// - 先查包围盒表拒绝越界位置，不访问棋盘
+// - 只遍历包围盒内的行，每行一次与运算：查表得到的行掩码 & 位棋盘对应行
+// 参数：
+// - id: 方块类型
+// - rot: 旋转状态
+// - x, y: 方块左上角在游戏网格中的位置
+// 返回：1表示碰撞，0表示无碰撞
+int tetris_core_collides(const TetrisCore* c, TetrominoId id, int rot, int x, int y) {
+    if (!tetris_piece_in_board(id, rot, x, y, c->width, c->height)) return 1;
+    const TetrisPieceBox* b = &tetris_piece_boxes[id][rot & 3];
+    for (int ry = b->min_y; ry <= b->max_y; ry++) {
+        if (tetris_piece_row(id, rot, x, ry) & c->rows[y + ry]) return 1;
+    }
+    return 0;
+}
+
+// 重新计算[x0, x1]列的空洞数与[x0-1, x1+1]列的井深，并汇总总空洞数与最高列
+static void refresh_stats(TetrisCore* c, int x0, int x1) {
+    TetrisBoardStats* st = &c->stats;
+    for (int x = x0; x <= x1; x++) st->holes[x] = (int16_t)(st->heights[x] - c->column_cells[x]);
+    if (x0 > 0) x0--;
+    if (x1 < c->width - 1) x1++;
+    for (int x = x0; x <= x1; x++) {
+        int left = x > 0 ? st->heights[x - 1] : c->height;
+        int right = x < c->width - 1 ? st->heights[x + 1] : c->height;
+        int side = left < right ? left : right;
+        st->wells[x] = (int16_t)(side > st->heights[x] ? side - st->heights[x] : 0);
+    }
+    st->total_holes = 0;
+    st->max_height = 0;
+    for (int x = 0; x < c->width; x++) {
+        st->total_holes += st->holes[x];
+        if (st->heights[x] > st->max_height) st->max_height = st->heights[x];
+    }
+}
+
+// 由位棋盘完整重建棋盘统计（读档、加载关卡后）
+static void rebuild_stats(TetrisCore* c) {
+    memset(&c->stats, 0, sizeof(c->stats));
+    memset(c->column_cells, 0, sizeof(c->column_cells));
+    for (int y = c->height - 1; y >= 0; y--) {
+        for (uint64_t m = c->rows[y]; m; m &= m - 1) {
+            int x = tetris_lowest_bit(m);
+            c->column_cells[x]++;
+            c->stats.heights[x] = (int16_t)(c->height - y);
+        }
+    }
+    refresh_stats(c, 0, c->width - 1);
+}
+
+const TetrisBoardStats* tetris_core_stats(const TetrisCore* c) {
+    return &c->stats;
+}
+
+// 锁定当前方块到游戏网格中
+// 功能点：
+// - 将当前下落方块固定到游戏网格上，并同步更新位棋盘
+// - 棋盘哈希按行增量更新：异或该行旧内容与新内容的哈希分量
+// - 棋盘统计只更新方块覆盖的列：列高取最大值、列格数加一，再刷新这些列的空洞与相邻列的井深
+// - 每个方块ID存储为(id + 1)，避免0值冲突
+// - 越界位置（例如损坏的存档）由包围盒表拒绝，合法位置的行掩码可直接写入
+static void lock_piece(TetrisCore* c) {
+    TetrominoId id = c->current_id;
+    int rot = c->current_rot;
+    if (!tetris_piece_in_board(id, rot, c->current_x, c->current_y, c->width, c->height)) return;
+    const TetrisPieceBox* b = &tetris_piece_boxes[id][rot & 3];
+    for (int ry = b->min_y; ry <= b->max_y; ry++) {
+        int gy = c->current_y + ry;
+        uint64_t m = tetris_piece_row(id, rot, c->current_x, ry);
+        c->hash ^= tetris_row_hash(gy, c->rows[gy]) ^ tetris_row_hash(gy, c->rows[gy] | m);
+        c->rows[gy] |= m;
+        uint8_t* line = c->grid + (size_t)gy * (size_t)c->width;
+        // 只遍历置位的列
+        for (; m; m &= m - 1) {
+            int gx = tetris_lowest_bit(m);
+            line[gx] = (uint8_t)(id + 1);
+            c->column_cells[gx]++;
+            if (c->stats.heights[gx] < c->height - gy) c->stats.heights[gx] = (int16_t)(c->height - gy);
+        }
+    }
+    refresh_stats(c, c->current_x + b->min_x, c->current_x + b->max_x);
+}
+
+// 根据grid重建位棋盘
+void tetris_core_sync_bitboard(TetrisCore* c) {
+    for (int y = 0; y < c->height; y++) {
+        const uint8_t* line = c->grid + (size_t)y * (size_t)c->width;
+        uint64_t row = 0;
+        for (int x = 0; x < c->width; x++) {
+            if (line[x]) row |= 1ULL << x;
+        }
+        c->rows[y] = row;
+    }
+    c->hash = tetris_hash_rows(c->rows, c->height);
+    rebuild_stats(c);
+}
+
+// 消行检测和处理函数
+// 功能点：
+// - 满行判断为 rows[y] == full_row
+// - 自底向上单次遍历：非满行直接搬到写入位置，满行跳过
+// - 顶部剩余的行清空
+// - 哈希增量更新：移除满行的键，搬动的行在旧行号去掉、在新行号加入
+// - 棋盘统计：满行覆盖每一列，各列格数减去消除行数；列顶不在满行上的列高度直接减去消除行数
+//   （满行只可能位于列顶之下），列顶恰好被消除的列从原列顶行向下找新的列顶
+// 返回：清除的行数
+static int clear_lines(TetrisCore* c) {
+    const size_t w = (size_t)c->width;
+    uint64_t top_cleared = 0;  // 列顶所在行被消除的列
+    // 最高列顶以上全为空行，只遍历[top, height)；满行之下的行不会移动，从最低的满行开始搬动
+    const int top = c->height - c->stats.max_height;
+    int src = c->height - 1;
+    while (src >= top && c->rows[src] != c->full_row) src--;
+    if (src < top) return 0;
+    int dst = src;
+    for (; src >= top; src--) {
+        if (c->rows[src] == c->full_row) {
+            c->hash ^= tetris_row_hash(src, c->full_row);
+            for (int x = 0; x < c->width; x++) {
+                if (c->height - c->stats.heights[x] == src) top_cleared |= 1ULL << x;
+            }
+            continue;
+        }
+        if (dst != src) {
+            c->hash ^= tetris_row_hash(src, c->rows[src]) ^ tetris_row_hash(dst, c->rows[src]);
+            c->rows[dst] = c->rows[src];
+            memcpy(c->grid + (size_t)dst * w, c->grid + (size_t)src * w, w);
+        }
+        dst--;
+    }
+    int cleared = dst - src;
+    // 清空顶部被空出的行（top以上本来就是空的）
+    for (; dst > src; dst--) {
+        c->rows[dst] = 0;
+        memset(c->grid + (size_t)dst * w, 0, w);
+    }
+    for (int x = 0; x < c->width; x++) {
+        c->column_cells[x] = (int16_t)(c->column_cells[x] - cleared);
+        if (!(top_cleared >> x & 1)) {
+            c->stats.heights[x] = (int16_t)(c->stats.heights[x] - cleared);
+            continue;
+        }
+        // 消行后新列顶不会高于原列顶
+        int y = c->height - c->stats.heights[x];
+        while (y < c->height && !(c->rows[y] >> x & 1)) y++;
+        c->stats.heights[x] = (int16_t)(c->height - y);
+    }
+    refresh_stats(c, 0, c->width - 1);
+    return cleared;
+}
+
+// 消行得分计算辅助函数
+// 功能点：
+// - 根据一次性消行数量计算基础得分
+// - 应用当前等级倍率
+// - 标准俄罗斯方块得分规则：1行=100分，2行=300分，3行=500分，4行=800分
+static int score_for_cleared(int lines, int level) {
+    if (lines <= 0) return 0;
+    int base = 0;
+    // 根据消行数量确定基础得分
+    switch (lines) {
+        case 1: base = 100; break;  // 单行消：100分
+        case 2: base = 300; break;  // 双行消：300分
+        case 3: base = 500; break;  // 三行消：500分
+        case 4: base = 800; break;  // 四行消：800分
+        default: base = 100 * lines; break;  // 多行消的简单计算
+    }
+    // 应用等级倍率（至少1级）
+    return base * (level > 0 ? level : 1);
+}
+
+// 从袋子取出下一个方块放到出生位置（不做碰撞检测）
+static void next_piece(TetrisCore* c) {
+    c->current_id = c->bag[c->bag_index++];
+    if (c->bag_index >= 7) shuffle_bag(c);  // 袋子用完重新洗牌
+    c->current_rot = 0;
+    c->current_x = (c->width - 4) / 2;
+    c->current_y = TETRIS_SPAWN_Y;
+    c->gravity_acc = 0;
+    c->lock_timer = 0;
+    c->lock_resets = 0;
+    c->lowest_y = TETRIS_SPAWN_Y;
+}
+
+// 11-19级每行的下落时间（微秒）：80ms逐级加快到1G（每帧一行）、2G、5G、10G
+static const uint32_t high_level_row_us[9] = { 80000, 60000, 50000, 40000, 30000, 16667, 8333, 3333, 1667 };
+
+// 按当前速度倍率由基础重力计算实际重力（不超过20G）
+static void update_gravity(TetrisCore* c) {
+    uint64_t g = (uint64_t)((double)c->base_gravity * c->speed_multiplier);
+    c->gravity = g > TETRIS_GRAVITY_20G ? TETRIS_GRAVITY_20G : (uint32_t)g;
+}
+
+void tetris_core_set_level(TetrisCore* c, int level) {
+    if (level < 1) level = 1;
+    c->level = level;
+    if (level >= 20) {
+        c->base_gravity = TETRIS_GRAVITY_20G;
+    } else {
+        // 1-10级每级缩短0.1秒（1.0秒到0.1秒），之后查高速档表
+        uint32_t row_us = level <= 10 ? (uint32_t)(TETRIS_TICKS_PER_SECOND - (level - 1) * (TETRIS_TICKS_PER_SECOND / 10)) * 1000u
+                                      : high_level_row_us[level - 11];
+        c->base_gravity = (uint32_t)((uint64_t)TETRIS_GRAVITY_ONE * 1000u / row_us);
+    }
+    update_gravity(c);
+}
+
+void tetris_core_set_speed_multiplier(TetrisCore* c, float mul) {
+    // 限制倍率范围
+    if (mul < 0.5f) mul = 0.5f;
+    if (mul > 2.0f) mul = 2.0f;
+    c->speed_multiplier = mul;
+    if (c->base_gravity == 0) tetris_core_set_level(c, c->level);
+    update_gravity(c);
+}
+
+// 锁定流程（自然落地与硬降共用）
+// 功能点：
+// - 锁定 → 消行 → 计分 → 升级 → 生成下一个方块，每一步写入对应事件（LOCK、CLEAR、LEVEL_UP、SPAWN）
+// - 新方块出生即碰撞时进入游戏结束状态（TOP_OUT）
+// - 自然落地、硬降与直接放置都只经过这一条流程
+static void lock_and_spawn(TetrisCore* c) {
+    lock_piece(c);
+    c->pieces_placed++;
+    emit(c, TETRIS_EVENT_LOCK, c->current_id);
+    int n = clear_lines(c);
+    if (n > 0) {
+        c->score += score_for_cleared(n, c->level);
+        c->lines_cleared += n;
+        emit(c, TETRIS_EVENT_CLEAR, n);
+        // 检查等级提升（每10行升一级）
+        int new_level = 1 + (c->lines_cleared / 10);
+        if (new_level != c->level) {
+            tetris_core_set_level(c, new_level);
+            emit(c, TETRIS_EVENT_LEVEL_UP, new_level);
+        }
+    }
+    next_piece(c);
+    if (tetris_core_collides(c, c->current_id, c->current_rot, c->current_x, c->current_y)) {
+        c->game_over = 1;
+        emit(c, TETRIS_EVENT_TOP_OUT, c->score);
+    } else {
+        emit(c, TETRIS_EVENT_SPAWN, c->current_id);
+    }
+}
+
+// 棋盘缓冲区：位棋盘与网格一次分配，网格紧跟在位棋盘之后
+static int alloc_board(int width, int height, uint64_t** rows, uint8_t** grid) {
+    if (width < TETRIS_MIN_WIDTH || width > TETRIS_MAX_WIDTH || height < TETRIS_MIN_HEIGHT || height > TETRIS_MAX_HEIGHT) return -1;
+    size_t row_bytes = sizeof(uint64_t) * (size_t)height;
+    uint8_t* p = (uint8_t*)malloc(row_bytes + (size_t)width * (size_t)height);
+    if (!p) return -2;
+    *rows = (uint64_t*)p;
+    *grid = p + row_bytes;
+    return 0;
+}
+
+static void set_board(TetrisCore* c, int width, int height, uint64_t* rows, uint8_t* grid) {
+    c->width = width;
+    c->height = height;
+    c->full_row = width == 64 ? ~0ULL : (1ULL << width) - 1;
+    c->rows = rows;
+    c->grid = grid;
+}
+
+int tetris_core_init(TetrisCore* c, int width, int height, uint32_t seed) {
+    memset(c, 0, sizeof(*c));
+    uint64_t* rows;
+    uint8_t* grid;
+    int ret = alloc_board(width, height, &rows, &grid);
+    if (ret != 0) return ret;
+    set_board(c, width, height, rows, grid);
+    tetris_core_reset(c, seed);
+    return 0;
+}
+
+void tetris_core_free(TetrisCore* c) {
+    free(c->rows);
+    c->rows = NULL;
+    c->grid = NULL;
+    c->width = c->height = 0;
+}
+
+int tetris_core_resize(TetrisCore* c, int width, int height, uint32_t seed) {
+    if (width == c->width && height == c->height) {
+        tetris_core_reset(c, seed);
+        return 0;
+    }
+    uint64_t* rows;
+    uint8_t* grid;
+    int ret = alloc_board(width, height, &rows, &grid);
+    if (ret != 0) return ret;
+    free(c->rows);
+    set_board(c, width, height, rows, grid);
+    tetris_core_reset(c, seed);
+    return 0;
+}
+
+int tetris_core_is_standard(const TetrisCore* c) {
+    return c->width == TETRIS_WIDTH && c->height == TETRIS_HEIGHT;
+}
+
+int tetris_core_standard_rows(const TetrisCore* c, uint16_t* out) {
+    if (!tetris_core_is_standard(c)) return -1;
+    for (int y = 0; y < TETRIS_HEIGHT; y++) out[y] = (uint16_t)c->rows[y];
+    return 0;
+}
+
+// 新的一局：棋盘尺寸与缓冲区保留，其余状态清零
+void tetris_core_reset(TetrisCore* c, uint32_t seed) {
+    int width = c->width, height = c->height;
+    uint64_t* rows = c->rows;
+    uint8_t* grid = c->grid;
+    memset(c, 0, sizeof(*c));
+    set_board(c, width, height, rows, grid);
+    memset(rows, 0, sizeof(uint64_t) * (size_t)height);
+    memset(grid, 0, (size_t)width * (size_t)height);
+    c->speed_multiplier = 1.0f;
+    c->lock_delay = TETRIS_LOCK_DELAY;
+    tetris_core_set_level(c, 1);
+    seed_rng(c, seed);
+    shuffle_bag(c);
+    next_piece(c);
+}
+
+void tetris_core_reseed(TetrisCore* c, uint32_t seed) {
+    seed_rng(c, seed);
+    shuffle_bag(c);
+    next_piece(c);
+}
+
+// 方块下落后：到达新的最低行时重新开始锁定计时，并恢复可重置次数
+static void note_descent(TetrisCore* c) {
+    if (c->current_y > c->lowest_y) {
+        c->lowest_y = c->current_y;
+        c->lock_timer = 0;
+        c->lock_resets = 0;
+    }
+}
+
+// 推进计时
+// 功能点：
+// - 重力按8.24定点累计，一次调用可下落多行；下落行数与影子位置比较（列高度查表，不逐行检测碰撞）
+// - 落地时剩余的下落量作废，从着地开始计锁定延迟；着地满lock_delay个tick后执行锁定流程
+// - 单次最多计入TETRIS_MAX_TICK_STEP个tick（暂停恢复后不会连续掉落）
+void tetris_core_tick(TetrisCore* c, uint32_t ticks) {
+    if (c->game_over) return;
+    if (ticks > TETRIS_MAX_TICK_STEP) ticks = TETRIS_MAX_TICK_STEP;
+    int dist = tetris_core_drop_distance(c, c->current_id, c->current_rot, c->current_x, c->current_y);
+    if (dist > 0) {
+        uint64_t acc = c->gravity_acc + (uint64_t)c->gravity * ticks;
+        uint64_t rows = acc >> TETRIS_GRAVITY_SHIFT;
+        if (rows < (uint64_t)dist) {
+            c->current_y += (int)rows;
+            c->gravity_acc = (uint32_t)(acc & (TETRIS_GRAVITY_ONE - 1));
+            note_descent(c);
+            return;
+        }
+        c->current_y += dist;
+        c->gravity_acc = 0;
+        note_descent(c);
+        ticks = 0;
+    }
+    c->lock_timer += ticks;
+    if (c->lock_timer >= c->lock_delay) lock_and_spawn(c);
+}
+
+// 下落距离
+// 功能点：
+// - 方块第cx列最低格在y + bottom[cx]行，该列最高占用格在height - heights行，差值减一即该列可下落行数
+// - 各列取最小值；列顶以上全为空，所以结果与逐行碰撞检测一致
+// - 方块已在某列列顶之下（塞入悬空块下方）时列高度无法说明下方情况，退回逐行检测
+int tetris_core_drop_distance(const TetrisCore* c, TetrominoId id, int rot, int x, int y) {
+    if (!tetris_piece_in_board(id, rot, x, y, c->width, c->height)) return 0;
+    const TetrisPieceBox* b = &tetris_piece_boxes[id][rot & 3];
+    int dist = c->height;
+    for (int cx = b->min_x; cx <= b->max_x; cx++) {
+        if (b->bottom[cx] < 0) continue;
+        int bottom = y + b->bottom[cx];
+        int top = c->height - c->stats.heights[x + cx];
+        if (bottom >= top) {
+            int d = 0;
+            while (!tetris_core_collides(c, id, rot, x, y + d + 1)) d++;
+            return d;
+        }
+        if (top - bottom - 1 < dist) dist = top - bottom - 1;
+    }
+    return dist;
+}
+
+int tetris_core_ghost_y(const TetrisCore* c) {
+    return c->current_y + tetris_core_drop_distance(c, c->current_id, c->current_rot, c->current_x, c->current_y);
+}
+
+int tetris_core_place(TetrisCore* c, int rot, int x, int y) {
+    if (c->game_over) return -1;
+    TetrominoId id = c->current_id;
+    if (tetris_core_collides(c, id, rot, x, y) || !tetris_core_collides(c, id, rot, x, y + 1)) return -1;
+    c->current_rot = rot & 3;
+    c->current_x = x;
+    c->current_y = y;
+    lock_and_spawn(c);
+    return 0;
+}
+
+// 着地等待锁定时平移/旋转成功：重置锁定计时（每个方块最多TETRIS_LOCK_RESETS次，避免无限拖延）
+static void reset_lock(TetrisCore* c) {
+    if (c->lock_timer > 0 && c->lock_resets < TETRIS_LOCK_RESETS) {
+        c->lock_timer = 0;
+        c->lock_resets++;
+    }
+}
+
+int tetris_core_move(TetrisCore* c, TetrisMove move) {
+    if (c->game_over) return 0;
+    int id = c->current_id, rot = c->current_rot, x = c->current_x, y = c->current_y;
+    switch (move) {
+        case TETRIS_MOVE_LEFT:
+            if (tetris_core_collides(c, id, rot, x - 1, y)) return 0;
+            c->current_x--;
+            reset_lock(c);
+            return 1;
+        case TETRIS_MOVE_RIGHT:
+            if (tetris_core_collides(c, id, rot, x + 1, y)) return 0;
+            c->current_x++;
+            reset_lock(c);
+            return 1;
+        case TETRIS_MOVE_SOFT_DROP:
+            if (tetris_core_collides(c, id, rot, x, y + 1)) return 0;
+            c->current_y++;
+            note_descent(c);
+            return 1;
+        case TETRIS_MOVE_ROTATE:
+            if (tetris_core_collides(c, id, (rot + 1) & 3, x, y)) return 0;
+            c->current_rot = (rot + 1) & 3;
+            reset_lock(c);
+            return 1;
+        case TETRIS_MOVE_HARD_DROP:
+            c->current_y = tetris_core_ghost_y(c);
+            lock_and_spawn(c);
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,184 @@
+#ifndef TETRIS_CORE_H
+#define TETRIS_CORE_H
+
+#include <stdint.h>
+
+// 俄罗斯方块规则核心（不依赖SDL、时钟和音频）
+// - 状态只有棋盘、方块袋、当前方块、分数等级、下落计时和随机数状态
+// - 每局独立的xoshiro128**随机数，同一种子得到相同的方块序列，多线程模拟互不干扰
+// - 通过显式的tick数和动作推进，可远快于实时运行（机器人、测试）
+// - 锁定/消行/升级等以事件形式记录，由前端转换为音效和画面
+
+// 俄罗斯方块游戏网格尺寸定义
+// 标准棋盘尺寸（默认尺寸；机器人、走法生成、评估、训练环境与撤销历史只支持标准棋盘）
+#define TETRIS_WIDTH 10   // 游戏区域宽度（列数）
+#define TETRIS_HEIGHT 20  // 游戏区域高度（行数）
+// 标准棋盘的满行位掩码（位x对应第x列）
+#define TETRIS_FULL_ROW ((uint16_t)((1u << TETRIS_WIDTH) - 1))
+// 运行时可选的棋盘尺寸范围：每行一个uint64_t位棋盘，因此最宽64列
+#define TETRIS_MIN_WIDTH 4
+#define TETRIS_MAX_WIDTH 64
+#define TETRIS_MIN_HEIGHT 4
+#define TETRIS_MAX_HEIGHT 1000
+
+// 每秒tick数（前端以毫秒驱动时1 tick = 1 ms）
+#define TETRIS_TICKS_PER_SECOND 1000
+// 重力：每tick下落的格数，8.24定点（1 << TETRIS_GRAVITY_SHIFT为每tick一格）
+#define TETRIS_GRAVITY_SHIFT 24
+#define TETRIS_GRAVITY_ONE (1u << TETRIS_GRAVITY_SHIFT)
+// 20G：每tick下落20格（标准棋盘上方块出生后立即到底；更高的棋盘按20格/tick下落）
+#define TETRIS_GRAVITY_20G ((uint32_t)20 << TETRIS_GRAVITY_SHIFT)
+// 锁定延迟（tick）与每个方块最多重置锁定计时的次数（着地后平移/旋转成功时重置）
+#define TETRIS_LOCK_DELAY 500
+#define TETRIS_LOCK_RESETS 15
+// 单次推进最多计入的tick数（暂停恢复或卡顿后不会一次跳过大段时间）
+#define TETRIS_MAX_TICK_STEP 250
+// 新方块出生位置（x为标准棋盘的值，其他宽度取(width - 4) / 2居中）
+#define TETRIS_SPAWN_X 3
+#define TETRIS_SPAWN_Y 0
+// 事件环容量（2的幂）：规则核心写入，前端每帧取走；满后新事件被丢弃并计数
+#define TETRIS_EVENT_RING_SIZE 32
+
+// 俄罗斯方块类型枚举（0-6）
+// TET_NONE用于表示没有方块
+typedef enum {
+    TET_I,      // I形方块（条形）
+    TET_O,      // O形方块（正方形）
+    TET_T,      // T形方块
+    TET_S,      // S形方块
+    TET_Z,      // Z形方块
+    TET_J,      // J形方块
+    TET_L,      // L形方块
+    TET_NONE = 255  // 无方块标识
+} TetrominoId;
+
+// 核心可执行的动作
+typedef enum {
+    TETRIS_MOVE_LEFT,       // 左移
+    TETRIS_MOVE_RIGHT,      // 右移
+    TETRIS_MOVE_ROTATE,     // 顺时针旋转
+    TETRIS_MOVE_SOFT_DROP,  // 下移一行
+    TETRIS_MOVE_HARD_DROP   // 直接落到底并锁定
+} TetrisMove;
+
+// 规则事件
+typedef enum {
+    TETRIS_EVENT_LOCK,      // 方块锁定
+    TETRIS_EVENT_CLEAR,     // 消行（value为行数）
+    TETRIS_EVENT_LEVEL_UP,  // 升级（value为新等级）
+    TETRIS_EVENT_SPAWN,     // 生成新方块（value为方块ID）
+    TETRIS_EVENT_TOP_OUT    // 新方块无法生成，游戏结束
+} TetrisEventType;
+
+typedef struct {
+    TetrisEventType type;
+    int value;
+} TetrisEvent;
+
+// 棋盘统计（锁定与消行时增量维护，不必重新扫描网格）
+// 数组按最大宽度分配，只有前width列有效
+typedef struct {
+    int16_t heights[TETRIS_MAX_WIDTH];  // 各列高度（最高占用格到底部的行数，空列为0）
+    int16_t holes[TETRIS_MAX_WIDTH];    // 各列空洞数（列顶以下的空格）
+    int16_t wells[TETRIS_MAX_WIDTH];    // 各列井深（两侧较低一侧高出本列的行数，墙壁视为满高）
+    int total_holes;
+    int max_height;
+} TetrisBoardStats;
+
+typedef struct {
+    // 棋盘尺寸（列数、行数）与对应的满行位掩码，由tetris_core_init/tetris_core_resize设置
+    int width, height;
+    uint64_t full_row;
+    // 游戏网格（堆上分配，按行主序grid[y * width + x]）：0表示空，>0表示已填充（颜色ID）
+    uint8_t* grid;
+    // 占用位棋盘（堆上分配）：每行一个uint64_t，位x表示第x列已填充，与grid保持同步
+    uint64_t* rows;
+    // 棋盘行哈希（各行tetris_row_hash分量的异或，只取决于占用格），锁定和消行时增量更新
+    uint64_t hash;
+    // 棋盘统计（只读，通过tetris_core_stats访问）与每列已填充格数
+    TetrisBoardStats stats;
+    int16_t column_cells[TETRIS_MAX_WIDTH];
+    // 方块袋系统（7种方块的随机序列）
+    TetrominoId bag[7];
+    int bag_index;
+    // 随机数（xoshiro128**）：seed为本局种子，rng为当前状态
+    uint32_t seed;
+    uint32_t rng[4];
+
+    // 当前下落方块状态
+    TetrominoId current_id;   // 当前方块类型
+    int current_rot;          // 当前旋转状态（0-3）
+    int current_x, current_y; // 当前方块原点位置
+
+    // 重力与锁定（单位：tick）
+    uint32_t gravity;             // 当前重力（8.24定点格/tick）
+    uint32_t base_gravity;        // 按等级的重力（应用速度倍率前）
+    uint32_t gravity_acc;         // 累计的不足一格的下落量
+    uint32_t lock_delay;          // 着地后多少tick锁定
+    uint32_t lock_timer;          // 本次着地已经过的tick数
+    int lock_resets;              // 本方块已重置锁定计时的次数
+    int lowest_y;                 // 本方块到达过的最低行（到达更低的行时重置锁定计时与次数）
+    float speed_multiplier;       // 速度倍率（0.5-2.0）
+
+    // 游戏统计数据
+    int score;         // 当前分数
+    int level;         // 当前等级
+    int lines_cleared; // 已消行数
+    uint32_t pieces_placed; // 已锁定的方块数
+    int game_over;     // 游戏结束标志（1=已结束）
+
+    // 待前端处理的事件（单生产者/单消费者环：核心只写event_head，消费者只写event_tail）
+    // 无界面使用（机器人、调参、训练环境）不必取走，满后只是丢弃
+    TetrisEvent events[TETRIS_EVENT_RING_SIZE];
+    uint32_t event_head;
+    uint32_t event_tail;
+    uint32_t events_dropped;  // 因环满丢弃的事件数
+} TetrisCore;
+
+// 初始化：分配width×height的棋盘并以seed开始新的一局
+// 返回：0=成功，-1=尺寸超出范围，-2=内存不足（失败时核心不持有内存，可直接丢弃）
+int tetris_core_init(TetrisCore* c, int width, int height, uint32_t seed);
+// 释放棋盘内存（之后需重新tetris_core_init才能使用）
+void tetris_core_free(TetrisCore* c);
+// 改变棋盘尺寸并以seed开始新的一局（只重置一次），返回值同tetris_core_init（失败时保持原尺寸和局面）
+int tetris_core_resize(TetrisCore* c, int width, int height, uint32_t seed);
+// 以seed开始新的一局：清空棋盘与统计，洗牌并生成第一个方块（速度倍率恢复为1.0，棋盘尺寸不变）
+void tetris_core_reset(TetrisCore* c, uint32_t seed);
+// 是否为标准10×20棋盘
+int tetris_core_is_standard(const TetrisCore* c);
+// 把标准棋盘的位棋盘导出为uint16_t行（机器人、训练环境使用），非标准尺寸返回-1
+int tetris_core_standard_rows(const TetrisCore* c, uint16_t* out);
+// 只更换种子：重新播种、重新洗牌并从新袋子取当前方块，棋盘和统计保持不变
+void tetris_core_reseed(TetrisCore* c, uint32_t seed);
+// 取下一个32位随机数
+uint32_t tetris_core_random(TetrisCore* c);
+// 之后的n个方块（不含当前方块），跨袋子时模拟后续洗牌，不改变本局状态
+void tetris_core_preview(const TetrisCore* c, TetrominoId* out, int n);
+// 取出一个待处理事件，成功返回1，环为空返回0
+int tetris_core_poll_event(TetrisCore* c, TetrisEvent* ev);
+// 丢弃全部待处理事件（状态被整体替换后调用，例如撤销）
+void tetris_core_clear_events(TetrisCore* c);
+// 推进ticks个tick：按重力累计下落量，一次可下落多行（最多落到影子位置），着地满锁定延迟后锁定
+void tetris_core_tick(TetrisCore* c, uint32_t ticks);
+// 执行动作，返回1表示状态发生了变化
+int tetris_core_move(TetrisCore* c, TetrisMove move);
+// 把当前方块直接放到(rot, x, y)并执行锁定流程（机器人与自我对弈用，落点来自tetris_movegen）
+// 返回：0=成功，-1=该位置碰撞或方块未着地（状态不变）
+int tetris_core_place(TetrisCore* c, int rot, int x, int y);
+// 方块在指定位置是否碰撞（越界或与已有方块重叠）
+int tetris_core_collides(const TetrisCore* c, TetrominoId id, int rot, int x, int y);
+// 当前棋盘统计（只读）
+const TetrisBoardStats* tetris_core_stats(const TetrisCore* c);
+// 方块从(x, y)能直接下落的行数：方块各列最低格与该列高度比较，最多4次查表
+// 方块位于某列顶部以下（塞在悬空块下方）时退回逐行碰撞检测
+int tetris_core_drop_distance(const TetrisCore* c, TetrominoId id, int rot, int x, int y);
+// 当前方块的影子位置（硬降后的y）
+int tetris_core_ghost_y(const TetrisCore* c);
+// 根据grid重建占用位棋盘、棋盘哈希与棋盘统计（直接修改grid后调用，例如读档或加载关卡）
+void tetris_core_sync_bitboard(TetrisCore* c);
+// 设置等级并按等级重新计算重力（1-10级每行1.0-0.1秒，之后逐级加快到20级起的20G）
+void tetris_core_set_level(TetrisCore* c, int level);
+// 设置速度倍率（限制在0.5-2.0）并重新计算重力
+void tetris_core_set_speed_multiplier(TetrisCore* c, float mul);
+
+#endif // TETRIS_CORE_H
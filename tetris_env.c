@@ -0,0 +1,147 @@
+#include "tetris_env.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 观测结构体必须保持64字节（训练端按固定布局解析）
+typedef char tetris_env_obs_layout_check[sizeof(TetrisEnvObs) == 64 ? 1 : -1];
+
+void tetris_env_default_config(TetrisEnvConfig* cfg, int num_envs) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->num_envs = num_envs;
+    cfg->mode = TETRIS_ENV_MOVES;
+    cfg->ticks_per_step = 100;
+    cfg->preview = TETRIS_ENV_MAX_PREVIEW;
+    cfg->max_steps = 0;
+}
+
+size_t tetris_env_obs_size(const TetrisEnvConfig* cfg) {
+    return sizeof(TetrisEnvObs) * (size_t)cfg->num_envs;
+}
+
+// 写入单个环境的观测（预览只在方块变化后重新计算）
+static void write_obs(TetrisEnv* env, int i) {
+    const TetrisCore* c = &env->games[i];
+    TetrisEnvObs* o = &env->obs[i];
+    tetris_core_standard_rows(c, o->rows);
+    o->current_id = (uint8_t)c->current_id;
+    o->current_rot = (uint8_t)c->current_rot;
+    o->current_x = (int8_t)c->current_x;
+    o->current_y = (int8_t)c->current_y;
+    o->score = c->score;
+    o->lines = c->lines_cleared;
+    o->pieces = c->pieces_placed;
+    if (env->preview_serial[i] != c->pieces_placed) {
+        TetrominoId next[TETRIS_ENV_MAX_PREVIEW];
+        tetris_core_preview(c, next, env->cfg.preview);
+        for (int k = 0; k < TETRIS_ENV_MAX_PREVIEW; k++) {
+            o->next[k] = (uint8_t)(k < env->cfg.preview ? next[k] : TET_NONE);
+        }
+        env->preview_serial[i] = c->pieces_placed;
+    }
+}
+
+// 由全局种子、环境序号和局数派生独立种子
+static uint32_t derive_seed(uint32_t seed, int index, uint32_t episode) {
+    uint32_t h = seed ^ (0x9E3779B9u * (uint32_t)(index + 1)) ^ (0x85EBCA6Bu * episode);
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    return h;
+}
+
+// 重置单个环境
+static void reset_one(TetrisEnv* env, int i) {
+    tetris_core_reset(&env->games[i], derive_seed(env->seed, i, env->episodes[i]));
+    env->episode_steps[i] = 0;
+    env->preview_serial[i] = 0xFFFFFFFFu;  // 强制重新写入预览
+    write_obs(env, i);
+}
+
+int tetris_env_init(TetrisEnv* env, const TetrisEnvConfig* cfg, void* obs_buffer) {
+    memset(env, 0, sizeof(*env));
+    if (!cfg || cfg->num_envs <= 0 || !obs_buffer || cfg->preview < 0 || cfg->preview > TETRIS_ENV_MAX_PREVIEW) {
+        return -1;
+    }
+    env->cfg = *cfg;
+    env->obs = (TetrisEnvObs*)obs_buffer;
+    size_t n = (size_t)cfg->num_envs;
+    env->games = (TetrisCore*)calloc(n, sizeof(TetrisCore));
+    env->preview_serial = (uint32_t*)calloc(n, sizeof(uint32_t));
+    env->episode_steps = (uint32_t*)calloc(n, sizeof(uint32_t));
+    env->episodes = (uint32_t*)calloc(n, sizeof(uint32_t));
+    if (!env->games || !env->preview_serial || !env->episode_steps || !env->episodes) {
+        tetris_env_free(env);
+        return -3;
+    }
+    // 观测按标准棋盘布局，各局固定为10×20
+    for (int i = 0; i < cfg->num_envs; i++) {
+        if (tetris_core_init(&env->games[i], TETRIS_WIDTH, TETRIS_HEIGHT, 0) != 0) {
+            tetris_env_free(env);
+            return -3;
+        }
+    }
+    tetris_env_reset(env, 0);
+    return 0;
+}
+
+void tetris_env_free(TetrisEnv* env) {
+    if (env->games) {
+        for (int i = 0; i < env->cfg.num_envs; i++) tetris_core_free(&env->games[i]);
+    }
+    free(env->games);
+    free(env->preview_serial);
+    free(env->episode_steps);
+    free(env->episodes);
+    memset(env, 0, sizeof(*env));
+}
+
+void tetris_env_reset(TetrisEnv* env, uint32_t seed) {
+    env->seed = seed;
+    for (int i = 0; i < env->cfg.num_envs; i++) {
+        env->episodes[i] = 0;
+        reset_one(env, i);
+    }
+}
+
+// 放置方式：动作解码为(旋转, x)，从当前行硬降；位置非法时按当前状态硬降
+static void apply_placement(TetrisCore* c, uint8_t action) {
+    int rot = (action / TETRIS_ENV_COLUMNS) & 3;
+    int x = action % TETRIS_ENV_COLUMNS - 3;
+    if (tetris_core_collides(c, c->current_id, rot, x, c->current_y)) {
+        tetris_core_move(c, TETRIS_MOVE_HARD_DROP);
+        return;
+    }
+    int y = c->current_y + tetris_core_drop_distance(c, c->current_id, rot, x, c->current_y);
+    tetris_core_place(c, rot, x, y);
+}
+
+// 推进一步
+// 功能点：
+// - 按键方式：执行一个动作后推进ticks_per_step个tick（重力下落与自然锁定由规则核心处理）
+// - 放置方式：每步锁定一个方块
+// - 奖励为本步消除的行数；游戏结束或达到最大步数时标记done并自动重置
+void tetris_env_step(TetrisEnv* env, const uint8_t* actions, float* rewards, uint8_t* dones) {
+    const TetrisEnvConfig* cfg = &env->cfg;
+    for (int i = 0; i < cfg->num_envs; i++) {
+        TetrisCore* c = &env->games[i];
+        int lines = c->lines_cleared;
+        uint8_t a = actions ? actions[i] : 0;
+        if (cfg->mode == TETRIS_ENV_PLACEMENTS) {
+            apply_placement(c, a);
+        } else {
+            if (a > TETRIS_ENV_NOOP && a < TETRIS_ENV_NUM_MOVES) tetris_core_move(c, (TetrisMove)(a - 1));
+            tetris_core_tick(c, cfg->ticks_per_step);
+        }
+        env->episode_steps[i]++;
+        if (rewards) rewards[i] = (float)(c->lines_cleared - lines);
+
+        int done = c->game_over || (cfg->max_steps && env->episode_steps[i] >= cfg->max_steps);
+        if (dones) dones[i] = (uint8_t)done;
+        if (done) {
+            env->episodes[i]++;
+            reset_one(env, i);
+        } else {
+            write_obs(env, i);
+        }
+    }
+}
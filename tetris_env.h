@@ -0,0 +1,82 @@
+#ifndef TETRIS_ENV_H
+#define TETRIS_ENV_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "tetris_core.h"
+
+// 向量化的俄罗斯方块训练环境（类gym接口，与chip8_env相同的用法）
+// - N局游戏同步推进，每步从actions数组取每局的动作
+// - 观测为定长结构体，直接写入调用者提供的连续缓冲区（可位于共享内存，见shm_buffer.h）
+// - 奖励为本步消除的行数；游戏结束或达到最大步数时标记done并独立自动重置
+// 多核使用：把同一块观测缓冲区按环境切片，每个线程/进程各自创建一个TetrisEnv
+
+// 预览方块数上限
+#define TETRIS_ENV_MAX_PREVIEW 5
+
+// 动作方式
+typedef enum {
+    TETRIS_ENV_MOVES,       // 每步一个按键动作（TetrisEnvAction），然后推进ticks_per_step个tick
+    TETRIS_ENV_PLACEMENTS   // 每步直接放置一个方块：动作 = 旋转 * TETRIS_ENV_COLUMNS + (x + 3)，从出生行硬降
+} TetrisEnvActionMode;
+
+// 按键动作（TETRIS_ENV_MOVES方式）
+typedef enum {
+    TETRIS_ENV_NOOP,
+    TETRIS_ENV_LEFT,
+    TETRIS_ENV_RIGHT,
+    TETRIS_ENV_ROTATE,
+    TETRIS_ENV_SOFT_DROP,
+    TETRIS_ENV_HARD_DROP,
+    TETRIS_ENV_NUM_MOVES
+} TetrisEnvAction;
+
+// 放置方式的列数（x取-3..TETRIS_WIDTH-1），动作总数为4 * TETRIS_ENV_COLUMNS
+#define TETRIS_ENV_COLUMNS (TETRIS_WIDTH + 3)
+
+// 单局观测（64字节，字段全部定宽，训练端可直接按结构化类型解析）
+typedef struct {
+    uint16_t rows[TETRIS_HEIGHT];          // 位棋盘：位x表示第x列已填充
+    uint8_t current_id;                    // 当前方块（TetrominoId）
+    uint8_t current_rot;
+    int8_t current_x, current_y;
+    uint8_t next[TETRIS_ENV_MAX_PREVIEW];  // 之后的方块（超出配置预览数的位置为TET_NONE）
+    uint8_t reserved[3];
+    int32_t score;
+    int32_t lines;
+    uint32_t pieces;                       // 本局已放置方块数
+} TetrisEnvObs;
+
+typedef struct {
+    int num_envs;               // 环境数量
+    TetrisEnvActionMode mode;
+    uint32_t ticks_per_step;    // 按键方式下每步推进的tick数（1 tick = 1 ms游戏时间）
+    int preview;                // 观测中的预览方块数（0..TETRIS_ENV_MAX_PREVIEW）
+    uint32_t max_steps;         // 每局最大步数（截断），0表示不限制
+} TetrisEnvConfig;
+
+typedef struct {
+    TetrisEnvConfig cfg;
+    TetrisCore* games;          // num_envs局
+    TetrisEnvObs* obs;          // 观测缓冲区（调用者所有）
+    uint32_t* preview_serial;   // 每局上次写入预览时的pieces_placed（方块变化时才重新计算预览）
+    uint32_t* episode_steps;    // 每局已运行的步数
+    uint32_t* episodes;         // 每局已完成的局数（用于派生种子）
+    uint32_t seed;
+} TetrisEnv;
+
+// 填充默认配置（按键方式，每步100 tick，预览5个方块）
+void tetris_env_default_config(TetrisEnvConfig* cfg, int num_envs);
+// 观测缓冲区字节数
+size_t tetris_env_obs_size(const TetrisEnvConfig* cfg);
+
+// 创建环境：obs_buffer至少tetris_env_obs_size字节（按8字节对齐），成功返回0
+int tetris_env_init(TetrisEnv* env, const TetrisEnvConfig* cfg, void* obs_buffer);
+void tetris_env_free(TetrisEnv* env);
+
+// 以seed重置全部环境并写入初始观测（环境i使用由seed和i派生的种子）
+void tetris_env_reset(TetrisEnv* env, uint32_t seed);
+// 推进一步：actions[i]为环境i的动作；rewards/dones各num_envs个元素（可为NULL）
+void tetris_env_step(TetrisEnv* env, const uint8_t* actions, float* rewards, uint8_t* dones);
+
+#endif // TETRIS_ENV_H
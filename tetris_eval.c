@@ -0,0 +1,241 @@
+#include "tetris_eval.h"
+#include <string.h>
+#include "tetris_pieces.h"
+#ifndef _MSC_VER
+#include <stdatomic.h>
+#endif
+
+// AVX2批量评估：编译器支持时编译，运行时检测CPU后启用
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#define EVAL_HAVE_AVX2 1
+#define EVAL_AVX2_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define EVAL_HAVE_AVX2 1
+#define EVAL_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+// 带墙壁的行：位0为左墙、位1..TETRIS_WIDTH为各列、位TETRIS_WIDTH+1为右墙
+#define EVAL_WALLS ((1u << (TETRIS_WIDTH + 1)) | 1u)
+// 行内相邻位置对的掩码（TETRIS_WIDTH + 1对）
+#define EVAL_PAIRS ((1u << (TETRIS_WIDTH + 1)) - 1)
+
+void tetris_eval_default_weights(TetrisWeights* w) {
+    w->w[TETRIS_W_HEIGHT] = -0.510066f;
+    w->w[TETRIS_W_HOLES] = -0.35663f;
+    w->w[TETRIS_W_BUMPINESS] = -0.184483f;
+    w->w[TETRIS_W_WELLS] = -0.05f;
+    w->w[TETRIS_W_ROW_TRANSITIONS] = 0.0f;
+    w->w[TETRIS_W_CLEAR1] = 0.760666f;
+    w->w[TETRIS_W_CLEAR2] = 1.521332f;
+    w->w[TETRIS_W_CLEAR3] = 2.281998f;
+    w->w[TETRIS_W_CLEAR4] = 3.042664f;
+}
+
+// 特征计算
+// 功能点：
+// - 自上而下扫描，seen为已出现过方块的列集合
+// - 本行首次出现的列即得到该列高度；seen中本行为空的列各计一个空洞
+// - 高度差与井深由列高度数组得到（墙壁视为无限高）
+// - 行变换：行两端补上墙壁后，相邻位置异或的置位数
+void tetris_eval_features(const uint16_t* rows, TetrisFeatures* f) {
+    unsigned seen = 0;
+    int holes = 0, transitions = 0;
+    for (int x = 0; x < TETRIS_WIDTH; x++) f->heights[x] = 0;
+    for (int y = 0; y < TETRIS_HEIGHT; y++) {
+        unsigned r = rows[y];
+        unsigned e = (r << 1) | EVAL_WALLS;
+        transitions += tetris_popcount((e ^ (e >> 1)) & EVAL_PAIRS);
+        holes += tetris_popcount(seen & ~r);
+        for (unsigned fresh = r & ~seen; fresh; fresh &= fresh - 1) {
+            f->heights[tetris_lowest_bit(fresh)] = TETRIS_HEIGHT - y;
+        }
+        seen |= r;
+    }
+    int agg = 0, bump = 0, wells = 0, maxh = 0;
+    for (int x = 0; x < TETRIS_WIDTH; x++) {
+        int h = f->heights[x];
+        agg += h;
+        if (h > maxh) maxh = h;
+        if (x + 1 < TETRIS_WIDTH) {
+            int d = h - f->heights[x + 1];
+            bump += d < 0 ? -d : d;
+        }
+        int left = x > 0 ? f->heights[x - 1] : TETRIS_HEIGHT;
+        int right = x + 1 < TETRIS_WIDTH ? f->heights[x + 1] : TETRIS_HEIGHT;
+        int side = left < right ? left : right;
+        if (side > h) wells += side - h;
+    }
+    f->aggregate_height = agg;
+    f->holes = holes;
+    f->bumpiness = bump;
+    f->wells = wells;
+    f->row_transitions = transitions;
+    f->max_height = maxh;
+}
+
+float tetris_eval_board(const uint16_t* rows, const TetrisWeights* w) {
+    TetrisFeatures f;
+    tetris_eval_features(rows, &f);
+    return w->w[TETRIS_W_HEIGHT] * (float)f.aggregate_height
+         + w->w[TETRIS_W_HOLES] * (float)f.holes
+         + w->w[TETRIS_W_BUMPINESS] * (float)f.bumpiness
+         + w->w[TETRIS_W_WELLS] * (float)f.wells
+         + w->w[TETRIS_W_ROW_TRANSITIONS] * (float)f.row_transitions;
+}
+
+void tetris_eval_batch_set(TetrisEvalBatch* b, int i, const uint16_t* rows) {
+    for (int y = 0; y < TETRIS_HEIGHT; y++) b->rows[y][i] = rows[y];
+}
+
+void tetris_eval_batch_scalar(const TetrisEvalBatch* b, int n, const TetrisWeights* w, float* out) {
+    for (int i = 0; i < n; i++) {
+        uint16_t rows[TETRIS_HEIGHT];
+        for (int y = 0; y < TETRIS_HEIGHT; y++) rows[y] = b->rows[y][i];
+        out[i] = tetris_eval_board(rows, w);
+    }
+}
+
+#ifdef EVAL_HAVE_AVX2
+// 每个字节4位一查的置位数（pshufb查表），结果按字节
+EVAL_AVX2_TARGET static inline __m256i popcount_bytes(__m256i v) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low4 = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, low4));
+    __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low4));
+    return _mm256_add_epi8(lo, hi);
+}
+
+// 按字节累加的计数合并为每个16位通道的计数
+EVAL_AVX2_TARGET static inline __m256i bytes_to_words(__m256i v) {
+    return _mm256_add_epi16(_mm256_and_si256(v, _mm256_set1_epi16(0x00FF)), _mm256_srli_epi16(v, 8));
+}
+
+// 16个通道的特征加权求和，写出16个float
+EVAL_AVX2_TARGET static inline void weigh(__m256i feature, float weight, __m256* lo, __m256* hi) {
+    __m256 wv = _mm256_set1_ps(weight);
+    __m256 f0 = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(feature)));
+    __m256 f1 = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(feature, 1)));
+    *lo = _mm256_add_ps(*lo, _mm256_mul_ps(wv, f0));
+    *hi = _mm256_add_ps(*hi, _mm256_mul_ps(wv, f1));
+}
+
+// 每字节计数每行最多加8，整盘扫描不能溢出
+#if TETRIS_HEIGHT * 8 > 255
+#error "批量评估的字节计数器会溢出，需要分段合并"
+#endif
+
+// AVX2批量评估
+// 功能点：
+// - 16个棋盘的同一行是一个256位向量，每行只做位运算和按字节查表的置位数
+// - 列高度之和 = Σ popcount(seen)，seen为自上而下累计的占用列（每列从首个方块起逐行计1）
+// - 空洞 = 列高度之和 - 已填充格数
+// - 高度差之和 = Σ popcount(seen ^ (seen >> 1))：相邻两列在seen中的差异行数正是高度差
+// - 井深之和 = Σ popcount(本列未出现、两侧已出现（墙壁视为已出现）)
+// - 计数按字节累加，扫描结束后再合并为16位，最后转float与权重相乘
+EVAL_AVX2_TARGET static void batch_avx2(const TetrisEvalBatch* b, const TetrisWeights* w, float* out) {
+    const __m256i full = _mm256_set1_epi16((short)TETRIS_FULL_ROW);
+    const __m256i adjacent = _mm256_set1_epi16((short)(TETRIS_FULL_ROW >> 1));
+    const __m256i left_wall = _mm256_set1_epi16(1);
+    const __m256i right_wall = _mm256_set1_epi16((short)(1u << (TETRIS_WIDTH - 1)));
+    const __m256i walls = _mm256_set1_epi16((short)EVAL_WALLS);
+    const __m256i pairs = _mm256_set1_epi16((short)EVAL_PAIRS);
+    __m256i seen = _mm256_setzero_si256();
+    __m256i height = seen, filled = seen, bump = seen, wells = seen, transitions = seen;
+    for (int y = 0; y < TETRIS_HEIGHT; y++) {
+        __m256i r = _mm256_loadu_si256((const __m256i*)b->rows[y]);
+        seen = _mm256_or_si256(seen, r);
+        height = _mm256_add_epi8(height, popcount_bytes(seen));
+        filled = _mm256_add_epi8(filled, popcount_bytes(r));
+        __m256i diff = _mm256_and_si256(_mm256_xor_si256(seen, _mm256_srli_epi16(seen, 1)), adjacent);
+        bump = _mm256_add_epi8(bump, popcount_bytes(diff));
+        __m256i left = _mm256_or_si256(_mm256_slli_epi16(seen, 1), left_wall);
+        __m256i right = _mm256_or_si256(_mm256_srli_epi16(seen, 1), right_wall);
+        __m256i well = _mm256_andnot_si256(seen, _mm256_and_si256(_mm256_and_si256(left, right), full));
+        wells = _mm256_add_epi8(wells, popcount_bytes(well));
+        __m256i e = _mm256_or_si256(_mm256_slli_epi16(r, 1), walls);
+        __m256i t = _mm256_and_si256(_mm256_xor_si256(e, _mm256_srli_epi16(e, 1)), pairs);
+        transitions = _mm256_add_epi8(transitions, popcount_bytes(t));
+    }
+    height = bytes_to_words(height);
+    __m256i holes = _mm256_sub_epi16(height, bytes_to_words(filled));
+    __m256 lo = _mm256_setzero_ps(), hi = _mm256_setzero_ps();
+    weigh(height, w->w[TETRIS_W_HEIGHT], &lo, &hi);
+    weigh(holes, w->w[TETRIS_W_HOLES], &lo, &hi);
+    weigh(bytes_to_words(bump), w->w[TETRIS_W_BUMPINESS], &lo, &hi);
+    weigh(bytes_to_words(wells), w->w[TETRIS_W_WELLS], &lo, &hi);
+    weigh(bytes_to_words(transitions), w->w[TETRIS_W_ROW_TRANSITIONS], &lo, &hi);
+    _mm256_storeu_ps(out, lo);
+    _mm256_storeu_ps(out + 8, hi);
+}
+
+// 运行时检测AVX2（同时要求操作系统保存YMM寄存器）
+static int detect_avx2(void) {
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7) return 0;
+    __cpuid(regs, 1);
+    if (!(regs[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6) return 0;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+// -1表示尚未检测；多个搜索线程可能同时首次调用，以relaxed原子读写
+// （重复检测结果相同，无需加锁，只需避免数据竞争）
+#ifdef _MSC_VER
+static volatile int simd_state = -1;   // 经__iso_volatile_load32/store32访问
+#else
+static _Atomic int simd_state = -1;
+#endif
+#endif
+
+int tetris_eval_simd_enabled(void) {
+#ifdef EVAL_HAVE_AVX2
+#ifdef _MSC_VER
+    int state = __iso_volatile_load32(&simd_state);
+    if (state < 0) {
+        state = detect_avx2();
+        __iso_volatile_store32(&simd_state, state);
+    }
+#else
+    int state = atomic_load_explicit(&simd_state, memory_order_relaxed);
+    if (state < 0) {
+        state = detect_avx2();
+        atomic_store_explicit(&simd_state, state, memory_order_relaxed);
+    }
+#endif
+    return state;
+#else
+    return 0;
+#endif
+}
+
+void tetris_eval_batch(const TetrisEvalBatch* b, int n, const TetrisWeights* w, float* out) {
+#ifdef EVAL_HAVE_AVX2
+    if (tetris_eval_simd_enabled()) {
+        float all[TETRIS_EVAL_BATCH];
+        batch_avx2(b, w, all);
+        memcpy(out, all, sizeof(float) * (size_t)n);
+        return;
+    }
+#endif
+    tetris_eval_batch_scalar(b, n, w, out);
+}
+
+int tetris_eval_spawn_blocked(const uint16_t* rows) {
+    static const uint16_t spawn_cols = (uint16_t)(0xF << TETRIS_SPAWN_X);
+    return ((rows[TETRIS_SPAWN_Y] | rows[TETRIS_SPAWN_Y + 1]) & spawn_cols) != 0;
+}
+
+float tetris_eval_clear_reward(int lines, const TetrisWeights* w) {
+    if (lines <= 0) return 0.0f;
+    if (lines > 4) lines = 4;
+    return w->w[TETRIS_W_CLEAR1 + lines - 1];
+}
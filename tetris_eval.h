@@ -0,0 +1,67 @@
+#ifndef TETRIS_EVAL_H
+#define TETRIS_EVAL_H
+
+#include <stdint.h>
+#include "tetris_core.h"
+
+// 棋盘启发式评估（机器人搜索与自我对弈调参共用）
+// 分数 = Σ 权重 × 特征，特征全部由位棋盘按位运算得到
+// - tetris_eval_board逐个棋盘计算（标量参照实现）
+// - tetris_eval_batch一次评估最多TETRIS_EVAL_BATCH个棋盘（结构数组布局，CPU支持时走AVX2）
+
+// 权重下标
+typedef enum {
+    TETRIS_W_HEIGHT,     // 各列高度之和
+    TETRIS_W_HOLES,      // 空洞数（上方有方块的空格）
+    TETRIS_W_BUMPINESS,  // 相邻列高度差绝对值之和
+    TETRIS_W_WELLS,      // 井深之和（比两侧都低的列）
+    TETRIS_W_ROW_TRANSITIONS,  // 行内空/满交替次数（两侧墙壁视为已填充）
+    TETRIS_W_CLEAR1,     // 一次消1行的奖励
+    TETRIS_W_CLEAR2,     // 一次消2行的奖励
+    TETRIS_W_CLEAR3,     // 一次消3行的奖励
+    TETRIS_W_CLEAR4,     // 一次消4行的奖励
+    TETRIS_NUM_WEIGHTS
+} TetrisWeightIndex;
+
+typedef struct {
+    float w[TETRIS_NUM_WEIGHTS];
+} TetrisWeights;
+
+typedef struct {
+    int heights[TETRIS_WIDTH];  // 各列高度（0表示空列）
+    int aggregate_height;
+    int holes;
+    int bumpiness;
+    int wells;
+    int row_transitions;
+    int max_height;
+} TetrisFeatures;
+
+// 批量评估的棋盘数：16个棋盘的同一行（16×16位）正好占一个256位寄存器
+#define TETRIS_EVAL_BATCH 16
+
+// 结构数组布局的一批棋盘：rows[y][i]为第i个棋盘的第y行
+typedef struct {
+    uint16_t rows[TETRIS_HEIGHT][TETRIS_EVAL_BATCH];
+} TetrisEvalBatch;
+
+// 填充默认权重
+void tetris_eval_default_weights(TetrisWeights* w);
+// 计算棋盘特征
+void tetris_eval_features(const uint16_t* rows, TetrisFeatures* f);
+// 棋盘静态评估（不含消行奖励），越大越好
+float tetris_eval_board(const uint16_t* rows, const TetrisWeights* w);
+// 把一个棋盘写入批次的第i个位置
+void tetris_eval_batch_set(TetrisEvalBatch* b, int i, const uint16_t* rows);
+// 批量静态评估：out[i]为第i个棋盘的值（i < n，n不超过TETRIS_EVAL_BATCH），与tetris_eval_board一致
+void tetris_eval_batch(const TetrisEvalBatch* b, int n, const TetrisWeights* w, float* out);
+// 批量评估的标量版本（参照实现，逐个调用tetris_eval_board）
+void tetris_eval_batch_scalar(const TetrisEvalBatch* b, int n, const TetrisWeights* w, float* out);
+// 批量评估是否使用AVX2
+int tetris_eval_simd_enabled(void);
+// 出生区域（前两行的出生列）是否已被占用：下一个方块无法生成，搜索中视为死局
+int tetris_eval_spawn_blocked(const uint16_t* rows);
+// 一次消除lines行的奖励
+float tetris_eval_clear_reward(int lines, const TetrisWeights* w);
+
+#endif // TETRIS_EVAL_H
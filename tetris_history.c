@@ -0,0 +1,116 @@
+#include "tetris_history.h"
+#include <string.h>
+#include "tetris_pieces.h"
+
+// 快照布局必须保持紧凑（环按固定大小内嵌）
+typedef char tetris_snapshot_layout_check[sizeof(TetrisSnapshot) == 120 ? 1 : -1];
+typedef char tetris_snapshot_row_check[TETRIS_WIDTH * 3 <= 32 ? 1 : -1];
+
+// 保存快照
+// 功能点：
+// - 只遍历已占用的格子（按位棋盘取最低置位），空行直接写0
+// - 方块袋、袋子索引与游戏结束标志打包进一个32位字
+// - 快照布局按标准棋盘，调用方保证核心为10×20（见tetris_history_sync）
+void tetris_snapshot_save(const TetrisCore* c, TetrisSnapshot* s) {
+    for (int y = 0; y < TETRIS_HEIGHT; y++) {
+        const uint8_t* line = c->grid + y * TETRIS_WIDTH;
+        uint32_t packed = 0;
+        for (uint64_t m = c->rows[y]; m; m &= m - 1) {
+            int x = tetris_lowest_bit(m);
+            uint32_t color = line[x] > 7 ? 7u : line[x];
+            packed |= color << (3 * x);
+        }
+        s->cells[y] = packed;
+    }
+    memcpy(s->rng, c->rng, sizeof(s->rng));
+    uint32_t bag = 0;
+    for (int i = 0; i < 7; i++) bag |= ((uint32_t)c->bag[i] & 7u) << (3 * i + 4);
+    s->bag = bag | ((uint32_t)c->bag_index & 7u) << 1 | (c->game_over ? 1u : 0u);
+    s->pieces_placed = c->pieces_placed;
+    s->score = c->score;
+    s->lines = c->lines_cleared;
+    s->level = (uint16_t)(c->level < 0xFFFF ? c->level : 0xFFFF);
+    s->current_id = (uint8_t)c->current_id;
+    s->current_rot = (uint8_t)c->current_rot;
+    s->current_x = (int8_t)c->current_x;
+    s->current_y = (int8_t)c->current_y;
+}
+
+// 还原快照
+// 功能点：
+// - 解包网格后由tetris_core_sync_bitboard重建位棋盘、哈希与棋盘统计
+// - 按快照中的等级和当前速度倍率重新计算重力，清空下落累计量、锁定计时与待处理事件
+void tetris_snapshot_restore(const TetrisSnapshot* s, TetrisCore* c) {
+    for (int y = 0; y < TETRIS_HEIGHT; y++) {
+        uint32_t packed = s->cells[y];
+        for (int x = 0; x < TETRIS_WIDTH; x++) {
+            c->grid[y * TETRIS_WIDTH + x] = (uint8_t)(packed >> (3 * x) & 7u);
+        }
+    }
+    tetris_core_sync_bitboard(c);
+    memcpy(c->rng, s->rng, sizeof(c->rng));
+    for (int i = 0; i < 7; i++) c->bag[i] = (TetrominoId)(s->bag >> (3 * i + 4) & 7u);
+    c->bag_index = (int)(s->bag >> 1 & 7u);
+    c->game_over = (int)(s->bag & 1u);
+    c->pieces_placed = s->pieces_placed;
+    c->score = s->score;
+    c->lines_cleared = s->lines;
+    tetris_core_set_level(c, s->level);
+    c->current_id = (TetrominoId)s->current_id;
+    c->current_rot = s->current_rot;
+    c->current_x = s->current_x;
+    c->current_y = s->current_y;
+    c->gravity_acc = 0;
+    c->lock_timer = 0;
+    c->lock_resets = 0;
+    c->lowest_y = c->current_y;
+    tetris_core_clear_events(c);
+}
+
+void tetris_history_clear(TetrisHistory* h) {
+    h->start = 0;
+    h->count = 0;
+    h->pos = 0;
+}
+
+static TetrisSnapshot* history_at(TetrisHistory* h, int i) {
+    return &h->ring[(h->start + i) % TETRIS_HISTORY_SIZE];
+}
+
+// 录入快照：丢弃当前位置之后被撤销的分支，环满时覆盖最旧的快照
+// 非标准尺寸的棋盘不录入（快照按10×20打包），历史保持为空
+int tetris_history_sync(TetrisHistory* h, const TetrisCore* c) {
+    if (!tetris_core_is_standard(c)) {
+        tetris_history_clear(h);
+        return 0;
+    }
+    if (h->count > 0 && history_at(h, h->pos)->pieces_placed == c->pieces_placed) return 0;
+    h->count = h->count > 0 ? h->pos + 1 : 0;
+    if (h->count == TETRIS_HISTORY_SIZE) {
+        h->start = (h->start + 1) % TETRIS_HISTORY_SIZE;
+        h->count--;
+    }
+    tetris_snapshot_save(c, history_at(h, h->count));
+    h->pos = h->count;
+    h->count++;
+    return 1;
+}
+
+int tetris_history_step(TetrisHistory* h, TetrisCore* c, int delta) {
+    if (h->count == 0) return 0;
+    int target = h->pos + delta;
+    if (target < 0) target = 0;
+    if (target > h->count - 1) target = h->count - 1;
+    int moved = target - h->pos;
+    h->pos = target;
+    tetris_snapshot_restore(history_at(h, target), c);
+    return moved;
+}
+
+int tetris_history_undo_count(const TetrisHistory* h) {
+    return h->count > 0 ? h->pos : 0;
+}
+
+int tetris_history_redo_count(const TetrisHistory* h) {
+    return h->count > 0 ? h->count - 1 - h->pos : 0;
+}
@@ -0,0 +1,55 @@
+#ifndef TETRIS_HISTORY_H
+#define TETRIS_HISTORY_H
+
+#include <stdint.h>
+#include "tetris_core.h"
+
+// 俄罗斯方块撤销/回退历史
+// - 每次方块锁定后保存一份紧凑快照，快照环内嵌在结构体中，录入时不分配内存
+// - 撤销/重做只是在环内移动游标并还原快照；撤销后锁定新方块会丢弃被撤销的分支
+// - 环满时覆盖最旧的快照
+// - 只支持标准10×20棋盘
+
+// 快照环容量
+#define TETRIS_HISTORY_SIZE 256
+
+// 紧凑快照（120字节）
+// - 每行TETRIS_WIDTH格×3位颜色（0为空，1-7为方块ID+1），占用位棋盘、哈希与统计还原时由网格重建
+// - 方块袋7个ID各3位，低位依次为袋子索引(3位)与游戏结束标志(1位)
+// - 速度倍率属于玩家设置，不随快照还原；下落计时还原为0
+typedef struct {
+    uint32_t cells[TETRIS_HEIGHT];
+    uint32_t rng[4];
+    uint32_t pieces_placed;
+    uint32_t bag;
+    int32_t score;
+    int32_t lines;
+    uint16_t level;
+    uint8_t current_id;
+    uint8_t current_rot;
+    int8_t current_x, current_y;
+} TetrisSnapshot;
+
+typedef struct {
+    TetrisSnapshot ring[TETRIS_HISTORY_SIZE];
+    int start;   // 最旧快照在环中的位置
+    int count;   // 有效快照数
+    int pos;     // 当前状态对应的快照序号（0..count-1，从最旧算起）
+} TetrisHistory;
+
+// 保存/还原单个快照
+void tetris_snapshot_save(const TetrisCore* c, TetrisSnapshot* s);
+void tetris_snapshot_restore(const TetrisSnapshot* s, TetrisCore* c);
+
+// 清空历史（新的一局或读档后调用）
+void tetris_history_clear(TetrisHistory* h);
+// 历史为空或核心已锁定新方块时录入快照并返回1，否则返回0（每次推进后调用，开销只是一次比较）
+// 非标准10×20棋盘不支持撤销：清空历史并返回0
+int tetris_history_sync(TetrisHistory* h, const TetrisCore* c);
+// 移动delta步（负数为撤销，正数为重做）并还原到对应快照，返回实际移动的步数
+int tetris_history_step(TetrisHistory* h, TetrisCore* c, int delta);
+// 可撤销/可重做的步数
+int tetris_history_undo_count(const TetrisHistory* h);
+int tetris_history_redo_count(const TetrisHistory* h);
+
+#endif // TETRIS_HISTORY_H
@@ -0,0 +1,110 @@
+#include "tetris_latency.h"
+#include <stdio.h>
+#include <string.h>
+#include <SDL.h>
+
+double tetris_clock_ms(void) {
+    static Uint64 perf0 = 0, freq = 0;
+    static Uint32 ticks0 = 0;
+    if (freq == 0) {
+        freq = SDL_GetPerformanceFrequency();
+        perf0 = SDL_GetPerformanceCounter();
+        ticks0 = SDL_GetTicks();
+    }
+    return ticks0 + (double)(SDL_GetPerformanceCounter() - perf0) * 1000.0 / (double)freq;
+}
+
+void tetris_latency_reset(TetrisLatency* l) {
+    memset(l, 0, sizeof(*l));
+}
+
+// 累计一个样本（事件时间戳只有毫秒精度，可能略晚于高精度时钟，负值按0计）
+static void histogram_add(TetrisLatencyHistogram* h, double ms) {
+    if (ms < 0.0) ms = 0.0;
+    int bin = (int)(ms * 1000.0 / TETRIS_LATENCY_BIN_US);
+    if (bin >= TETRIS_LATENCY_BINS) bin = TETRIS_LATENCY_BINS - 1;
+    h->bins[bin]++;
+    h->count++;
+    if (ms > h->max_ms) h->max_ms = ms;
+}
+
+void tetris_latency_action(TetrisLatency* l, double event_ms, double now_ms) {
+    if (l->pending_count >= TETRIS_LATENCY_PENDING) return;
+    TetrisLatencySample* s = &l->pending[l->pending_count++];
+    s->event_ms = event_ms;
+    s->action_ms = now_ms;
+    s->submit_ms = 0.0;
+}
+
+void tetris_latency_submit(TetrisLatency* l, double now_ms) {
+    for (int i = 0; i < l->pending_count; i++) {
+        if (l->pending[i].submit_ms == 0.0) l->pending[i].submit_ms = now_ms;
+    }
+}
+
+void tetris_latency_present(TetrisLatency* l, double now_ms) {
+    int kept = 0;
+    for (int i = 0; i < l->pending_count; i++) {
+        const TetrisLatencySample* s = &l->pending[i];
+        if (s->submit_ms == 0.0) {
+            l->pending[kept++] = *s;
+            continue;
+        }
+        histogram_add(&l->stages[TETRIS_LATENCY_QUEUE], s->action_ms - s->event_ms);
+        histogram_add(&l->stages[TETRIS_LATENCY_RENDER], s->submit_ms - s->action_ms);
+        histogram_add(&l->stages[TETRIS_LATENCY_PRESENT], now_ms - s->submit_ms);
+        histogram_add(&l->stages[TETRIS_LATENCY_TOTAL], now_ms - s->event_ms);
+    }
+    l->pending_count = kept;
+}
+
+// 百分位：按累计计数找到所在分桶，返回桶的上沿（不超过最大值）
+double tetris_latency_percentile(const TetrisLatencyHistogram* h, double pct) {
+    if (h->count == 0) return 0.0;
+    uint64_t target = (uint64_t)(pct / 100.0 * h->count + 0.5);
+    if (target < 1) target = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < TETRIS_LATENCY_BINS - 1; i++) {
+        seen += h->bins[i];
+        if (seen >= target) {
+            double edge = (i + 1) * TETRIS_LATENCY_BIN_US / 1000.0;
+            return edge < h->max_ms ? edge : h->max_ms;
+        }
+    }
+    return h->max_ms;
+}
+
+const char* tetris_latency_stage_name(TetrisLatencyStage stage) {
+    switch (stage) {
+        case TETRIS_LATENCY_QUEUE: return "event->action";
+        case TETRIS_LATENCY_RENDER: return "action->submit";
+        case TETRIS_LATENCY_PRESENT: return "submit->present";
+        case TETRIS_LATENCY_TOTAL: return "event->present";
+        default: return "?";
+    }
+}
+
+// 导出统计
+// 功能点：
+// - 每个阶段一行汇总（样本数、p50、p90、p99、最大值）
+// - 随后列出非空分桶（桶下沿毫秒与计数），便于用外部工具画图
+int tetris_latency_dump(const TetrisLatency* l, const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+    for (int s = 0; s < TETRIS_LATENCY_STAGES; s++) {
+        const TetrisLatencyHistogram* h = &l->stages[s];
+        fprintf(f, "%s count=%u p50=%.1f p90=%.1f p99=%.1f max=%.2f\n", tetris_latency_stage_name((TetrisLatencyStage)s),
+                h->count, tetris_latency_percentile(h, 50.0), tetris_latency_percentile(h, 90.0),
+                tetris_latency_percentile(h, 99.0), h->max_ms);
+    }
+    for (int s = 0; s < TETRIS_LATENCY_STAGES; s++) {
+        const TetrisLatencyHistogram* h = &l->stages[s];
+        fprintf(f, "\n[%s]\n", tetris_latency_stage_name((TetrisLatencyStage)s));
+        for (int i = 0; i < TETRIS_LATENCY_BINS; i++) {
+            if (h->bins[i]) fprintf(f, "%.1f %u\n", i * TETRIS_LATENCY_BIN_US / 1000.0, h->bins[i]);
+        }
+    }
+    int ok = ferror(f) == 0;
+    fclose(f);
+    return ok ? 0 : -1;
+}
@@ -0,0 +1,61 @@
+#ifndef TETRIS_LATENCY_H
+#define TETRIS_LATENCY_H
+
+#include <stdint.h>
+
+// 输入到画面的延迟统计
+// - 每个按下的动作记录四个时间点：SDL事件时间戳、执行tetris_perform_action、提交渲染（SDL_RenderPresent之前）、SDL_RenderPresent返回
+// - 四个时间点之间的三段与总延迟分别累计到固定分桶的直方图，查询p50/p99不需要保存原始样本
+// - 所有时间都取自tetris_clock_ms（与SDL事件时间戳同一时间轴）
+
+// 直方图：0.1毫秒一桶，覆盖0-100毫秒，最后一桶收集更长的延迟
+#define TETRIS_LATENCY_BIN_US 100
+#define TETRIS_LATENCY_BINS 1001
+// F4导出的默认文件
+#define TETRIS_LATENCY_DEFAULT_PATH "tetris_latency.txt"
+// 等待上屏的输入数上限（一帧内的按键超过此数时不再采样）
+#define TETRIS_LATENCY_PENDING 16
+
+typedef enum {
+    TETRIS_LATENCY_QUEUE = 0,   // 事件 -> 执行动作（输入排队与固定步长量化）
+    TETRIS_LATENCY_RENDER,      // 执行动作 -> 提交渲染（等待本帧剩余的模拟与绘制）
+    TETRIS_LATENCY_PRESENT,     // 提交渲染 -> SDL_RenderPresent返回（垂直同步等待）
+    TETRIS_LATENCY_TOTAL,       // 事件 -> SDL_RenderPresent返回
+    TETRIS_LATENCY_STAGES
+} TetrisLatencyStage;
+
+typedef struct {
+    uint32_t bins[TETRIS_LATENCY_BINS];
+    uint32_t count;
+    double max_ms;
+} TetrisLatencyHistogram;
+
+typedef struct {
+    double event_ms;
+    double action_ms;
+    double submit_ms;   // 0表示尚未提交渲染
+} TetrisLatencySample;
+
+typedef struct {
+    TetrisLatencyHistogram stages[TETRIS_LATENCY_STAGES];
+    TetrisLatencySample pending[TETRIS_LATENCY_PENDING];
+    int pending_count;
+} TetrisLatency;
+
+// 高精度当前时间（毫秒）：以SDL_GetTicks为起点、用性能计数器细分
+double tetris_clock_ms(void);
+
+void tetris_latency_reset(TetrisLatency* l);
+// 动作被执行时调用（event_ms为SDL事件时间戳）
+void tetris_latency_action(TetrisLatency* l, double event_ms, double now_ms);
+// 本帧绘制完成、即将SDL_RenderPresent时调用
+void tetris_latency_submit(TetrisLatency* l, double now_ms);
+// SDL_RenderPresent返回后调用：已提交的样本计入直方图
+void tetris_latency_present(TetrisLatency* l, double now_ms);
+// 百分位（0-100），无样本返回0
+double tetris_latency_percentile(const TetrisLatencyHistogram* h, double pct);
+const char* tetris_latency_stage_name(TetrisLatencyStage stage);
+// 把各阶段的统计与非空分桶写入文本文件，成功返回0
+int tetris_latency_dump(const TetrisLatency* l, const char* path);
+
+#endif // TETRIS_LATENCY_H
@@ -0,0 +1,263 @@
+#include "tetris_movegen.h"
+#include <string.h>
+#include "tetris_pieces.h"
+
+// 有效列位（x = -3..TETRIS_WIDTH-1）
+#define MG_COLUMN_BITS ((uint16_t)((1u << TETRIS_PIECE_COLUMNS) - 1))
+
+// 计算free表
+// 功能点：
+// - 扩展行：位(c + 3)为第c列，两侧墙壁和棋盘外的行视为全满
+// - 方块位于(ry, k)的格子：在位置x碰撞当且仅当扩展行ry第(x + 3 + k)位为1，即 ext >> k
+// - 每个方块恰好4格，每个(旋转, y)只需4次移位或运算
+// - 堆叠上方的空行只受墙壁限制，每种旋转只算一次
+// 返回：第一个非空行（全空时为TETRIS_HEIGHT）
+static int build_free(TetrisMoveGen* g, const uint16_t* rows) {
+    const uint32_t walls = ((1u << TETRIS_PIECE_X_OFFSET) - 1) | ~((1u << TETRIS_PIECE_COLUMNS) - 1);
+    uint32_t ext[TETRIS_HEIGHT + 4];
+    int top = TETRIS_HEIGHT;
+    for (int y = TETRIS_HEIGHT - 1; y >= 0; y--) {
+        ext[y] = ((uint32_t)rows[y] << TETRIS_PIECE_X_OFFSET) | walls;
+        if (rows[y]) top = y;
+    }
+    for (int y = TETRIS_HEIGHT; y < TETRIS_HEIGHT + 4; y++) ext[y] = 0xFFFFFFFFu;
+    // y + 3 < top 的位置，方块所在的行全部为空
+    int open_rows = top - 3 > 0 ? top - 3 : 0;
+
+    for (int r = 0; r < 4; r++) {
+        // 方块4个格子的(行, 列)偏移
+        const TetrisPieceBox* b = &tetris_piece_boxes[g->id][r];
+        int cy[4], cx[4], nc = 0;
+        for (int ry = b->min_y; ry <= b->max_y; ry++) {
+            for (unsigned p = tetris_piece_row(g->id, r, 0, ry); p && nc < 4; p &= p - 1) {
+                cy[nc] = ry;
+                cx[nc] = tetris_lowest_bit(p);
+                nc++;
+            }
+        }
+        uint16_t open = (uint16_t)(~((walls >> cx[0]) | (walls >> cx[1]) | (walls >> cx[2]) | (walls >> cx[3]))
+                                   & MG_COLUMN_BITS);
+        for (int y = 0; y < open_rows; y++) g->free[r][y] = open;
+        for (int y = open_rows; y < TETRIS_HEIGHT; y++) {
+            uint32_t hit = (ext[y + cy[0]] >> cx[0]) | (ext[y + cy[1]] >> cx[1])
+                         | (ext[y + cy[2]] >> cx[2]) | (ext[y + cy[3]] >> cx[3]);
+            g->free[r][y] = (uint16_t)(~hit & MG_COLUMN_BITS);
+        }
+        g->free[r][TETRIS_HEIGHT] = 0;
+    }
+    return top;
+}
+
+// 行内左右洪泛：把m扩展到f中与之相连的整段（对数步的前缀传播）
+static uint16_t fill_runs(uint16_t m, uint16_t f) {
+    uint32_t up = m, down = m, pu = f, pd = f;
+    up |= pu & (up << 1);   pu &= pu << 1;
+    up |= pu & (up << 2);   pu &= pu << 2;
+    up |= pu & (up << 4);   pu &= pu << 4;
+    up |= pu & (up << 8);
+    down |= pd & (down >> 1); pd &= pd >> 1;
+    down |= pd & (down >> 2); pd &= pd >> 2;
+    down |= pd & (down >> 4); pd &= pd >> 4;
+    down |= pd & (down >> 8);
+    return (uint16_t)((up | down) & f);
+}
+
+// 同一行内的闭包：左右平移和旋转直到不再扩大
+// 用待处理集合记录需要重新洪泛的旋转状态，每个状态通常只处理一次
+static void close_row(TetrisMoveGen* g, int y) {
+    unsigned pending = 0;
+    for (int r = 0; r < 4; r++) {
+        if (g->reach[r][y]) pending |= 1u << r;
+    }
+    while (pending) {
+        int r = tetris_lowest_bit(pending);
+        pending &= pending - 1;
+        // 左右平移的洪泛（位x与x±1相邻）
+        uint16_t m = fill_runs(g->reach[r][y], g->free[r][y]);
+        g->reach[r][y] = m;
+        // 顺时针旋转到r+1
+        int nr = (r + 1) & 3;
+        uint16_t rot = m & g->free[nr][y];
+        if (rot & ~g->reach[nr][y]) {
+            g->reach[nr][y] |= rot;
+            pending |= 1u << nr;
+        }
+    }
+}
+
+// 占用格相同的旋转状态：返回更小的旋转序号及其原点偏移，没有则返回-1
+static int alias_rotation(TetrominoId id, int r, int* dx, int* dy) {
+    const TetrisPieceBox* b = &tetris_piece_boxes[id][r];
+    for (int a = 0; a < r; a++) {
+        const TetrisPieceBox* ab = &tetris_piece_boxes[id][a];
+        if (ab->max_x - ab->min_x != b->max_x - b->min_x || ab->max_y - ab->min_y != b->max_y - b->min_y) continue;
+        int same = 1;
+        for (int k = 0; k <= b->max_y - b->min_y && same; k++) {
+            unsigned m1 = tetris_piece_row(id, r, 0, b->min_y + k) >> b->min_x;
+            unsigned m2 = tetris_piece_row(id, a, 0, ab->min_y + k) >> ab->min_x;
+            same = m1 == m2;
+        }
+        if (same) {
+            *dx = b->min_x - ab->min_x;
+            *dy = b->min_y - ab->min_y;
+            return a;
+        }
+    }
+    return -1;
+}
+
+// 枚举落点
+// 功能点：
+// - 自上而下逐行：行内闭包（平移+旋转），再把仍可放置的位置下移到下一行
+// - 落点 = 可到达且下一行不可放置的位置
+// - 对称旋转的落点换算到较小的旋转序号去重
+int tetris_movegen_generate(TetrisMoveGen* g, const uint16_t* rows, TetrominoId id,
+                            int start_x, int start_rot, int start_y,
+                            TetrisPlacement* out, int max_out) {
+    g->id = id;
+    g->start_x = start_x;
+    g->start_rot = start_rot & 3;
+    g->start_y = start_y;
+    memset(g->reach, 0, sizeof(g->reach));
+    if (id > TET_L || start_y < 0 || start_y >= TETRIS_HEIGHT
+        || start_x < -TETRIS_PIECE_X_OFFSET || start_x >= TETRIS_WIDTH) return 0;
+    int top = build_free(g, rows);
+    uint16_t sbit = (uint16_t)(1u << (start_x + TETRIS_PIECE_X_OFFSET));
+    if (!(g->free[g->start_rot][start_y] & sbit)) return 0;
+    g->reach[g->start_rot][start_y] = sbit;
+
+    // 堆叠上方的空行：free与上一行相同，闭包结果直接下传
+    int y = start_y;
+    close_row(g, y);
+    while (y + 1 < TETRIS_HEIGHT && y + 1 + 3 < top) {
+        for (int r = 0; r < 4; r++) g->reach[r][y + 1] = g->reach[r][y];
+        y++;
+    }
+    int last = y;
+    for (; y < TETRIS_HEIGHT; y++) {
+        if (y > start_y) close_row(g, y);
+        last = y;
+        if (y + 1 >= TETRIS_HEIGHT) break;
+        uint16_t down = 0;
+        for (int r = 0; r < 4; r++) {
+            g->reach[r][y + 1] = g->reach[r][y] & g->free[r][y + 1];
+            down |= g->reach[r][y + 1];
+        }
+        if (!down) break;  // 下面的行都不可到达
+    }
+
+    int n = 0;
+    int alias[4], adx[4], ady[4];
+    for (int r = 0; r < 4; r++) alias[r] = alias_rotation(id, r, &adx[r], &ady[r]);
+    for (int r = 0; r < 4; r++) {
+        for (int y = start_y; y <= last; y++) {
+            unsigned land = g->reach[r][y] & ~g->free[r][y + 1];
+            for (; land; land &= land - 1) {
+                int x = tetris_lowest_bit(land) - TETRIS_PIECE_X_OFFSET;
+                // 等价落点已由较小的旋转序号给出
+                if (alias[r] >= 0) {
+                    int ax = x + adx[r], ay = y + ady[r];
+                    if (ay >= 0 && ay < TETRIS_HEIGHT && ax >= -TETRIS_PIECE_X_OFFSET && ax < TETRIS_WIDTH) {
+                        uint16_t abit = (uint16_t)(1u << (ax + TETRIS_PIECE_X_OFFSET));
+                        if ((g->reach[alias[r]][ay] & abit) && !(g->free[alias[r]][ay + 1] & abit)) continue;
+                    }
+                }
+                if (n < max_out) {
+                    out[n].x = (int8_t)x;
+                    out[n].y = (int8_t)y;
+                    out[n].rot = (int8_t)r;
+                }
+                n++;
+            }
+        }
+    }
+    return n < max_out ? n : max_out;
+}
+
+// 状态编号：(y * 4 + rot) * 16 + (x + 3)
+#define MG_STATE(x, r, y) ((((y) * 4 + (r)) << 4) | ((x) + TETRIS_PIECE_X_OFFSET))
+#define MG_NUM_STATES (TETRIS_HEIGHT * 4 * 16)
+
+// 求输入路径
+// 功能点：
+// - 在reach集合内做BFS（每个状态的可行性只需查free表）
+// - 沿父节点回溯；末尾连续的下移合并为一次硬降，末步不是下移时补一次硬降锁定
+int tetris_movegen_path(const TetrisMoveGen* g, const TetrisPlacement* p, TetrisPath* path) {
+    int16_t parent[MG_NUM_STATES];
+    uint8_t via[MG_NUM_STATES];
+    uint16_t queue[MG_NUM_STATES];
+    path->length = 0;
+    int target = MG_STATE(p->x, p->rot & 3, p->y);
+    int start = MG_STATE(g->start_x, g->start_rot, g->start_y);
+    if (p->y < 0 || p->y >= TETRIS_HEIGHT || p->x < -TETRIS_PIECE_X_OFFSET || p->x >= TETRIS_WIDTH) return -1;
+    if (!(g->reach[p->rot & 3][p->y] & (1u << (p->x + TETRIS_PIECE_X_OFFSET)))) return -1;
+    memset(parent, 0xFF, sizeof(parent));
+    int head = 0, tail = 0;
+    queue[tail++] = (uint16_t)start;
+    parent[start] = (int16_t)start;
+    while (head < tail && parent[target] < 0) {
+        int s = queue[head++];
+        int x = (s & 15) - TETRIS_PIECE_X_OFFSET, r = (s >> 4) & 3, y = s >> 6;
+        static const TetrisMove order[4] = {
+            TETRIS_MOVE_LEFT, TETRIS_MOVE_RIGHT, TETRIS_MOVE_ROTATE, TETRIS_MOVE_SOFT_DROP
+        };
+        for (int k = 0; k < 4; k++) {
+            int nx = x, nr = r, ny = y;
+            switch (order[k]) {
+                case TETRIS_MOVE_LEFT: nx--; break;
+                case TETRIS_MOVE_RIGHT: nx++; break;
+                case TETRIS_MOVE_ROTATE: nr = (r + 1) & 3; break;
+                default: ny++; break;
+            }
+            if (ny >= TETRIS_HEIGHT || nx < -TETRIS_PIECE_X_OFFSET || nx >= TETRIS_WIDTH) continue;
+            if (!(g->free[nr][ny] & (1u << (nx + TETRIS_PIECE_X_OFFSET)))) continue;
+            int ns = MG_STATE(nx, nr, ny);
+            if (parent[ns] >= 0) continue;
+            parent[ns] = (int16_t)s;
+            via[ns] = (uint8_t)order[k];
+            queue[tail++] = (uint16_t)ns;
+        }
+    }
+    if (parent[target] < 0) return -1;
+
+    // 回溯（倒序写入后翻转）
+    uint8_t rev[MG_NUM_STATES];
+    int len = 0;
+    for (int s = target; s != start; s = parent[s]) rev[len++] = via[s];
+    int i = 0;
+    while (i < len && rev[i] == TETRIS_MOVE_SOFT_DROP) i++;  // 末尾的连续下移
+    if (len - i + 1 > TETRIS_MAX_PATH) return -2;
+    for (int k = len - 1; k >= i; k--) path->moves[path->length++] = rev[k];
+    path->moves[path->length++] = TETRIS_MOVE_HARD_DROP;
+    return 0;
+}
+
+int tetris_movegen_apply(uint16_t* rows, uint64_t* hash, TetrominoId id, const TetrisPlacement* p) {
+    const TetrisPieceBox* b = &tetris_piece_boxes[id][p->rot & 3];
+    uint64_t h = hash ? *hash : 0;
+    int full = 0;
+    for (int ry = b->min_y; ry <= b->max_y; ry++) {
+        int y = p->y + ry;
+        uint16_t r = (uint16_t)(rows[y] | tetris_piece_row(id, p->rot, p->x, ry));
+        h ^= tetris_row_hash(y, rows[y]) ^ tetris_row_hash(y, r);
+        rows[y] = r;
+        if (r == TETRIS_FULL_ROW) full = 1;
+    }
+    if (full) {
+        // 自底向上压缩满行，搬动的行在哈希中换到新行号
+        int dst = TETRIS_HEIGHT - 1;
+        for (int src = TETRIS_HEIGHT - 1; src >= 0; src--) {
+            uint16_t r = rows[src];
+            if (r == TETRIS_FULL_ROW) {
+                h ^= tetris_row_hash(src, r);
+                continue;
+            }
+            if (dst != src) h ^= tetris_row_hash(src, r) ^ tetris_row_hash(dst, r);
+            rows[dst--] = r;
+        }
+        full = dst + 1;
+        for (; dst >= 0; dst--) rows[dst] = 0;
+    }
+    if (hash) *hash = h;
+    return full;
+}
@@ -0,0 +1,54 @@
+#ifndef TETRIS_MOVEGEN_H
+#define TETRIS_MOVEGEN_H
+
+#include <stdint.h>
+#include "tetris_core.h"
+
+// 落点生成器：枚举当前方块所有可到达的锁定位置（含软降后平移/旋转的“塞入”位置）
+// - 与tetris_core_collides语义一致：左移、右移、顺时针旋转、下移一行
+// - 先按行计算每个(旋转, y)下可放置的x位集合，再逐行做位并行的洪泛，无需逐状态碰撞检测
+// - 占用格完全相同的落点（如S/Z/I的对称旋转）只保留一个
+// - 输入路径按需单独求取（BFS最短路径），生成落点本身不记录路径
+
+// 单局最多的落点数（4种旋转×13列×20行的上界）
+#define TETRIS_MAX_PLACEMENTS 256
+// 输入路径最大长度
+#define TETRIS_MAX_PATH 64
+
+// 最终锁定位置（x/y为4x4区域左上角，与TetrisCore.current_x/current_y同义）
+typedef struct {
+    int8_t x;
+    int8_t y;
+    int8_t rot;
+} TetrisPlacement;
+
+// 到达某落点的输入序列，最后一步总是TETRIS_MOVE_HARD_DROP
+typedef struct {
+    int length;
+    uint8_t moves[TETRIS_MAX_PATH];  // TetrisMove
+} TetrisPath;
+
+// 生成器上下文（生成落点后可继续用于求路径）
+typedef struct {
+    TetrominoId id;
+    int start_x, start_rot, start_y;
+    // free[r][y]：位(x + TETRIS_PIECE_X_OFFSET)表示旋转r的方块可放在(x, y)
+    uint16_t free[4][TETRIS_HEIGHT + 1];
+    // reach[r][y]：可到达的位置集合（同样按位表示x）
+    uint16_t reach[4][TETRIS_HEIGHT];
+} TetrisMoveGen;
+
+// 在位棋盘rows上，从(start_x, start_rot, start_y)出发枚举方块id的全部落点
+// 返回落点数量（起始位置非法时返回0），最多写入max_out个
+int tetris_movegen_generate(TetrisMoveGen* g, const uint16_t* rows, TetrominoId id,
+                            int start_x, int start_rot, int start_y,
+                            TetrisPlacement* out, int max_out);
+
+// 求从起始位置到落点p的最短输入序列（需先调用tetris_movegen_generate），成功返回0
+int tetris_movegen_path(const TetrisMoveGen* g, const TetrisPlacement* p, TetrisPath* path);
+
+// 把落点写入位棋盘并消除满行（只操作位棋盘），返回消除的行数
+// hash非NULL时按与TetrisCore相同的规则增量更新棋盘哈希
+int tetris_movegen_apply(uint16_t* rows, uint64_t* hash, TetrominoId id, const TetrisPlacement* p);
+
+#endif // TETRIS_MOVEGEN_H
@@ -0,0 +1,37 @@
+#include "tetris_pieces.h"
+
+// 形状常量（I、O、T、S、Z、J、L各4种旋转状态），以宏形式提供以便参与常量表达式
+#define TETROMINO_SHAPES(X) \
+    X(0x0F00, 0x2222, 0x00F0, 0x4444) /* I形方块（条形） */ \
+    X(0x6600, 0x6600, 0x6600, 0x6600) /* O形方块（正方形） */ \
+    X(0x0E40, 0x4C40, 0x04E0, 0x4640) /* T形方块 */ \
+    X(0x06C0, 0x8C40, 0x06C0, 0x8C40) /* S形方块 */ \
+    X(0x0C60, 0x4C80, 0x0C60, 0x4C80) /* Z形方块 */ \
+    X(0x08E0, 0x44C0, 0x0E20, 0xC880) /* J形方块 */ \
+    X(0x02E0, 0x88C0, 0x0E80, 0xC440) /* L形方块 */
+
+// 4位翻转：形状数据中rx=0位于半字节最高位，位棋盘中第0列位于最低位
+#define PM_REV4(n) ((((n) & 1) << 3) | (((n) & 2) << 1) | (((n) & 4) >> 1) | (((n) & 8) >> 3))
+// 第ry行的占用掩码（位rx对应4x4区域第rx列）
+#define PM_ROW(s, ry) PM_REV4(((s) >> ((3 - (ry)) * 4)) & 0xF)
+// 包围盒：各行掩码的并集给出列范围，首个/末个非空行给出行范围
+#define PB_COLS(s) (PM_ROW(s, 0) | PM_ROW(s, 1) | PM_ROW(s, 2) | PM_ROW(s, 3))
+#define PB_LOW_BIT(m) (((m) & 1) ? 0 : ((m) & 2) ? 1 : ((m) & 4) ? 2 : 3)
+#define PB_HIGH_BIT(m) (((m) & 8) ? 3 : ((m) & 4) ? 2 : ((m) & 2) ? 1 : 0)
+#define PB_MIN_Y(s) (PM_ROW(s, 0) ? 0 : PM_ROW(s, 1) ? 1 : PM_ROW(s, 2) ? 2 : 3)
+#define PB_MAX_Y(s) (PM_ROW(s, 3) ? 3 : PM_ROW(s, 2) ? 2 : PM_ROW(s, 1) ? 1 : 0)
+#define PB_CELL(s, ry, c) ((PM_ROW(s, ry) >> (c)) & 1)
+#define PB_BOTTOM(s, c) \
+    (PB_CELL(s, 3, c) ? 3 : PB_CELL(s, 2, c) ? 2 : PB_CELL(s, 1, c) ? 1 : PB_CELL(s, 0, c) ? 0 : -1)
+#define PB_BOX(s) { \
+    PB_LOW_BIT(PB_COLS(s)), PB_HIGH_BIT(PB_COLS(s)), PB_MIN_Y(s), PB_MAX_Y(s), \
+    { PB_BOTTOM(s, 0), PB_BOTTOM(s, 1), PB_BOTTOM(s, 2), PB_BOTTOM(s, 3) } }
+
+#define SHAPE_ENTRY(a, b, c, d) { a, b, c, d },
+#define PR_ROT(s) { PM_ROW(s, 0), PM_ROW(s, 1), PM_ROW(s, 2), PM_ROW(s, 3) }
+#define ROW_ENTRY(a, b, c, d) { PR_ROT(a), PR_ROT(b), PR_ROT(c), PR_ROT(d) },
+#define BOX_ENTRY(a, b, c, d) { PB_BOX(a), PB_BOX(b), PB_BOX(c), PB_BOX(d) },
+
+const uint16_t tetris_piece_shapes[7][4] = { TETROMINO_SHAPES(SHAPE_ENTRY) };
+const uint8_t tetris_piece_rows[7][4][4] = { TETROMINO_SHAPES(ROW_ENTRY) };
+const TetrisPieceBox tetris_piece_boxes[7][4] = { TETROMINO_SHAPES(BOX_ENTRY) };
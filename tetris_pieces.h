@@ -0,0 +1,88 @@
+#ifndef TETRIS_PIECES_H
+#define TETRIS_PIECES_H
+
+#include <stdint.h>
+#include "tetris_core.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// 方块形状查找表（编译期由形状常量经宏展开生成，无运行时初始化）
+// - x为4x4区域左上角所在列（-3..棋盘宽度-1），行掩码按x平移到棋盘列：位gx对应第gx列，与TetrisCore.rows可直接按位与
+// - 越界位置的掩码不完整，使用前必须先用包围盒判断合法性
+#define TETRIS_PIECE_X_OFFSET 3
+// 默认宽度棋盘上x的取值个数（走法生成等16位行的使用者）
+#define TETRIS_PIECE_COLUMNS (TETRIS_WIDTH + TETRIS_PIECE_X_OFFSET)
+
+// 单个旋转状态的包围盒（相对4x4区域）
+typedef struct {
+    int8_t min_x, max_x;   // 占用列范围
+    int8_t min_y, max_y;   // 占用行范围
+    int8_t bottom[4];      // 每列最低占用格的行号（该列为空时为-1），用于计算落点
+} TetrisPieceBox;
+
+// 形状数据：7种方块×4种旋转状态，16位按行主序排列的4x4网格
+extern const uint16_t tetris_piece_shapes[7][4];
+// 行表：[方块][旋转][行]，位rx对应4x4区域第rx列
+extern const uint8_t tetris_piece_rows[7][4][4];
+// 包围盒表：[方块][旋转]
+extern const TetrisPieceBox tetris_piece_boxes[7][4];
+
+// 包围盒判断：方块在(x, y)处是否完全位于width×height的棋盘内
+static inline int tetris_piece_in_board(int id, int rot, int x, int y, int width, int height) {
+    const TetrisPieceBox* b = &tetris_piece_boxes[id][rot & 3];
+    return x + b->min_x >= 0 && x + b->max_x < width
+        && y + b->min_y >= 0 && y + b->max_y < height;
+}
+
+// 默认尺寸棋盘上的包围盒判断
+static inline int tetris_piece_in_bounds(int id, int rot, int x, int y) {
+    return tetris_piece_in_board(id, rot, x, y, TETRIS_WIDTH, TETRIS_HEIGHT);
+}
+
+// 取方块在第x列时第ry行的掩码（x >= -TETRIS_PIECE_X_OFFSET；移出左边界的位被丢弃，由包围盒负责拒绝）
+static inline uint64_t tetris_piece_row(int id, int rot, int x, int ry) {
+    uint64_t r = tetris_piece_rows[id][rot & 3][ry];
+    return x >= 0 ? r << x : r >> -x;
+}
+
+// 行掩码中最低置位的列号（m不能为0）
+static inline int tetris_lowest_bit(uint64_t m) {
+#ifdef _MSC_VER
+    unsigned long i;
+    _BitScanForward64(&i, m);
+    return (int)i;
+#else
+    return __builtin_ctzll(m);
+#endif
+}
+
+// 行掩码中置位的个数
+static inline int tetris_popcount(uint64_t m) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(m);
+#else
+    return __builtin_popcountll(m);
+#endif
+}
+
+// 第y行占用掩码为mask时的哈希分量（空行为0）
+// - 以行为单位：行号经黄金比例乘法展开后与掩码异或，再做splitmix64终结混合（对固定行号是双射，不同掩码不会碰撞）
+// - 棋盘哈希 = 各行分量的异或，只与占用格有关（与颜色无关）；任意宽度都只需一次混合，无查找表
+// - 行内容变化时异或旧分量与新分量即可增量更新
+static inline uint64_t tetris_row_hash(int y, uint64_t mask) {
+    if (!mask) return 0;
+    uint64_t z = mask ^ (uint64_t)(y + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// 整个棋盘的行哈希（各行分量异或；增量维护的参照实现，也用于读档后重建）
+static inline uint64_t tetris_hash_rows(const uint64_t* rows, int height) {
+    uint64_t h = 0;
+    for (int y = 0; y < height; y++) h ^= tetris_row_hash(y, rows[y]);
+    return h;
+}
+
+#endif // TETRIS_PIECES_H
@@ -0,0 +1,211 @@
+#include "tetris_replay.h"
+#include "varint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_VERSION 3  // 版本3：按行混合的棋盘哈希与可变棋盘尺寸（版本2的哈希无法校验）
+#define REPLAY_HEADER_SIZE 40
+// TICK参数占varint的高30位；更长的间隔与2^30效果相同（超过任何下落间隔，只触发一次下落）
+#define REPLAY_MAX_TICKS ((1u << 30) - 1)
+
+// 小端读写辅助函数
+static void put_u16(uint8_t* p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void put_u32(uint8_t* p, uint32_t v) { put_u16(p, (uint16_t)v); put_u16(p + 2, (uint16_t)(v >> 16)); }
+static uint16_t get_u16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t get_u32(const uint8_t* p) { return (uint32_t)get_u16(p) | ((uint32_t)get_u16(p + 2) << 16); }
+
+void tetris_replay_begin(TetrisReplay* r, TetrisCore* c, uint32_t seed) {
+    memset(r, 0, sizeof(*r));
+    r->seed = seed;
+    r->width = c->width;
+    r->height = c->height;
+    tetris_core_reset(c, seed);
+}
+
+// 追加一个事件（录制路径按需扩容）
+static int append_event(TetrisReplay* r, TetrisReplayEventType type, uint32_t arg, const uint32_t* extra) {
+    if (r->size + VARINT_MAX_BYTES + 4 > r->cap) {
+        size_t ncap = r->cap ? r->cap * 2 : 1024;
+        uint8_t* n = (uint8_t*)realloc(r->data, ncap);
+        if (!n) return -1;
+        r->data = n;
+        r->cap = ncap;
+    }
+    r->size += (size_t)varint_write(r->data + r->size, arg << 2 | (uint32_t)type);
+    if (extra) {
+        put_u32(r->data + r->size, *extra);
+        r->size += 4;
+    }
+    r->event_count++;
+    return 0;
+}
+
+int tetris_replay_record_tick(TetrisReplay* r, uint32_t ticks) {
+    if (ticks > REPLAY_MAX_TICKS) ticks = REPLAY_MAX_TICKS;
+    if (append_event(r, TETRIS_REPLAY_TICK, ticks, NULL) != 0) return -1;
+    r->total_ticks += ticks;
+    return 0;
+}
+
+int tetris_replay_record_move(TetrisReplay* r, TetrisMove move) {
+    return append_event(r, TETRIS_REPLAY_MOVE, (uint32_t)move, NULL);
+}
+
+int tetris_replay_record_speed(TetrisReplay* r, float mul) {
+    uint32_t bits;
+    memcpy(&bits, &mul, sizeof(bits));
+    return append_event(r, TETRIS_REPLAY_SPEED, 0, &bits);
+}
+
+int tetris_replay_record_reset(TetrisReplay* r, uint32_t seed) {
+    return append_event(r, TETRIS_REPLAY_RESET, 0, &seed);
+}
+
+void tetris_replay_end(TetrisReplay* r, const TetrisCore* c) {
+    r->final_score = c->score;
+    r->final_lines = c->lines_cleared;
+    r->final_pieces = c->pieces_placed;
+    r->final_hash = c->hash;
+}
+
+void tetris_replay_free(TetrisReplay* r) {
+    free(r->data);
+    memset(r, 0, sizeof(*r));
+}
+
+int tetris_replay_save(const TetrisReplay* r, const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return -1;
+    uint8_t hdr[REPLAY_HEADER_SIZE];
+    memset(hdr, 0, sizeof(hdr));
+    memcpy(hdr, "TTRP", 4);
+    hdr[4] = REPLAY_VERSION;
+    hdr[5] = (uint8_t)r->width;
+    put_u16(hdr + 6, (uint16_t)r->height);
+    put_u32(hdr + 8, r->seed);
+    put_u32(hdr + 12, r->total_ticks);
+    put_u32(hdr + 16, r->event_count);
+    put_u32(hdr + 20, (uint32_t)r->final_score);
+    put_u32(hdr + 24, (uint32_t)r->final_lines);
+    put_u32(hdr + 28, r->final_pieces);
+    put_u32(hdr + 32, (uint32_t)r->final_hash);
+    put_u32(hdr + 36, (uint32_t)(r->final_hash >> 32));
+    int ok = fwrite(hdr, 1, sizeof(hdr), f) == sizeof(hdr)
+          && (r->size == 0 || fwrite(r->data, 1, r->size, f) == r->size);
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+int tetris_replay_load(TetrisReplay* r, const char* path) {
+    memset(r, 0, sizeof(*r));
+    FILE* f = fopen(path, "rb");
+    if (!f) return -1;
+    uint8_t hdr[REPLAY_HEADER_SIZE];
+    if (fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr) || memcmp(hdr, "TTRP", 4) != 0 || hdr[4] != REPLAY_VERSION) {
+        fclose(f);
+        return -2;
+    }
+    r->width = hdr[5];
+    r->height = get_u16(hdr + 6);
+    r->seed = get_u32(hdr + 8);
+    r->total_ticks = get_u32(hdr + 12);
+    r->event_count = get_u32(hdr + 16);
+    r->final_score = (int32_t)get_u32(hdr + 20);
+    r->final_lines = (int32_t)get_u32(hdr + 24);
+    r->final_pieces = get_u32(hdr + 28);
+    r->final_hash = (uint64_t)get_u32(hdr + 32) | ((uint64_t)get_u32(hdr + 36) << 32);
+    // 读取剩余的事件流
+    fseek(f, 0, SEEK_END);
+    long end = ftell(f);
+    fseek(f, REPLAY_HEADER_SIZE, SEEK_SET);
+    if (end > REPLAY_HEADER_SIZE) {
+        r->cap = r->size = (size_t)(end - REPLAY_HEADER_SIZE);
+        r->data = (uint8_t*)malloc(r->size);
+        if (!r->data || fread(r->data, 1, r->size, f) != r->size) {
+            fclose(f);
+            tetris_replay_free(r);
+            return -3;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+int tetris_replay_prepare(const TetrisReplay* r, TetrisCore* c, TetrisReplayCursor* cur) {
+    memset(cur, 0, sizeof(*cur));
+    int ret = tetris_core_resize(c, r->width, r->height, r->seed);
+    if (ret != 0) {
+        cur->done = 1;
+        return ret;
+    }
+    cur->done = r->size == 0;
+    return 0;
+}
+
+// 应用事件
+// 功能点：
+// - 解码游标处的一个事件；TICK事件的结束时间戳超过until_tick时不消耗，留到下次调用
+// - 事件流截断或类型非法时标记done，之后不再应用任何事件
+// 返回：1=应用了一个事件，0=未到时间或已结束
+static int apply_next(const TetrisReplay* r, TetrisReplayCursor* cur, TetrisCore* c, uint32_t until_tick) {
+    const uint8_t* end = r->data + r->size;
+    uint32_t head = 0;
+    int n = varint_read(r->data + cur->pos, end, &head);
+    if (n == 0) {
+        cur->done = 1;
+        return 0;
+    }
+    uint32_t arg = head >> 2;
+    size_t next = cur->pos + (size_t)n;
+    switch ((TetrisReplayEventType)(head & 3)) {
+        case TETRIS_REPLAY_TICK:
+            if (cur->tick + arg > until_tick) return 0;
+            tetris_core_tick(c, arg);
+            cur->tick += arg;
+            break;
+        case TETRIS_REPLAY_MOVE:
+            tetris_core_move(c, (TetrisMove)arg);
+            break;
+        case TETRIS_REPLAY_SPEED:
+        case TETRIS_REPLAY_RESET: {
+            if (next + 4 > r->size) {
+                cur->done = 1;
+                return 0;
+            }
+            uint32_t v = get_u32(r->data + next);
+            next += 4;
+            if ((head & 3) == TETRIS_REPLAY_SPEED) {
+                float mul;
+                memcpy(&mul, &v, sizeof(mul));
+                tetris_core_set_speed_multiplier(c, mul);
+            } else {
+                tetris_core_reset(c, v);
+            }
+            break;
+        }
+    }
+    cur->pos = next;
+    cur->events++;
+    if (cur->pos >= r->size) cur->done = 1;
+    return 1;
+}
+
+uint32_t tetris_replay_advance(const TetrisReplay* r, TetrisReplayCursor* cur, TetrisCore* c, uint32_t until_tick) {
+    uint32_t applied = 0;
+    while (!cur->done && apply_next(r, cur, c, until_tick)) applied++;
+    return applied;
+}
+
+// 全速回放：只做事件解码与规则推进（无前端消费事件，事件环满后直接丢弃）
+uint32_t tetris_replay_run(const TetrisReplay* r, TetrisCore* c) {
+    TetrisReplayCursor cur;
+    if (tetris_replay_prepare(r, c, &cur) != 0) return 0;
+    tetris_replay_advance(r, &cur, c, UINT32_MAX);
+    return cur.events;
+}
+
+int tetris_replay_verify(const TetrisReplay* r, const TetrisCore* c) {
+    return c->score == r->final_score && c->lines_cleared == r->final_lines
+        && c->pieces_placed == r->final_pieces && c->hash == r->final_hash ? 0 : -1;
+}
@@ -0,0 +1,80 @@
+#ifndef TETRIS_REPLAY_H
+#define TETRIS_REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "tetris_core.h"
+
+// 俄罗斯方块回放（确定性录制与回放，与chip8_journal相同的思路）
+// 规则核心只由种子、tick推进和动作决定，因此录制这三类输入即可逐tick复现整局
+// 文件格式（小端）：
+//   "TTRP" 魔数 | 版本(1字节) | 棋盘宽度(1字节) | 棋盘高度(2字节) | 初始种子(4字节) | 总tick数(4字节) | 事件数(4字节)
+//   | 结束时分数(4字节) | 消行数(4字节) | 方块数(4字节) | 棋盘哈希(8字节) | 事件流
+// 事件流中每个事件以varint(参数 << 2 | 类型)开头：
+//   TICK   参数为本次推进的tick数（事件时间戳即之前全部TICK之和），通常2字节
+//   MOVE   参数为TetrisMove，1字节
+//   SPEED  参数为0，后跟4字节速度倍率（float原始位，保证回放时下落间隔完全一致）
+//   RESET  参数为0，后跟4字节新种子（录制中途重新开始一局，棋盘尺寸不变）
+// 版本3起棋盘哈希按行混合计算并记录棋盘尺寸，旧版本的录制无法校验，不再读取
+typedef enum {
+    TETRIS_REPLAY_TICK,
+    TETRIS_REPLAY_MOVE,
+    TETRIS_REPLAY_SPEED,
+    TETRIS_REPLAY_RESET
+} TetrisReplayEventType;
+
+// 默认回放文件
+#define TETRIS_REPLAY_DEFAULT_PATH "tetris_replay.ttr"
+
+typedef struct {
+    uint32_t seed;              // 录制开始时的种子
+    int width, height;          // 棋盘尺寸
+    uint32_t total_ticks;       // 录制的总tick数
+    uint32_t event_count;       // 事件数
+
+    // 结束时的状态（回放后用于校验确定性）
+    int32_t final_score;
+    int32_t final_lines;
+    uint32_t final_pieces;
+    uint64_t final_hash;
+
+    // 编码后的事件流
+    uint8_t* data;
+    size_t size;
+    size_t cap;
+} TetrisReplay;
+
+// 回放游标：事件流读取位置与已回放的tick数
+typedef struct {
+    size_t pos;
+    uint32_t tick;
+    uint32_t events;            // 已应用的事件数
+    int done;                   // 事件流已读完（或数据损坏）
+} TetrisReplayCursor;
+
+// 开始录制：以seed重置规则核心（录制总是从新的一局开始），记下当前棋盘尺寸
+void tetris_replay_begin(TetrisReplay* r, TetrisCore* c, uint32_t seed);
+// 记录输入（在调用对应的核心函数之前调用），失败返回-1
+int tetris_replay_record_tick(TetrisReplay* r, uint32_t ticks);
+int tetris_replay_record_move(TetrisReplay* r, TetrisMove move);
+int tetris_replay_record_speed(TetrisReplay* r, float mul);
+int tetris_replay_record_reset(TetrisReplay* r, uint32_t seed);
+// 结束录制：保存结束时的分数、消行数、方块数和棋盘哈希
+void tetris_replay_end(TetrisReplay* r, const TetrisCore* c);
+void tetris_replay_free(TetrisReplay* r);
+
+// 保存/读取回放文件，成功返回0
+int tetris_replay_save(const TetrisReplay* r, const char* path);
+int tetris_replay_load(TetrisReplay* r, const char* path);
+
+// 回放准备：把已初始化的规则核心调整为录制时的棋盘尺寸，并以录制的初始种子重置
+// 返回：0=成功，负数=无法调整棋盘尺寸（游标标记为done）
+int tetris_replay_prepare(const TetrisReplay* r, TetrisCore* c, TetrisReplayCursor* cur);
+// 应用时间戳不超过until_tick的全部事件（按任意速度渲染回放时每帧调用），返回本次应用的事件数
+uint32_t tetris_replay_advance(const TetrisReplay* r, TetrisReplayCursor* cur, TetrisCore* c, uint32_t until_tick);
+// 无界面全速回放全部事件（核心需已初始化），返回应用的事件数
+uint32_t tetris_replay_run(const TetrisReplay* r, TetrisCore* c);
+// 校验回放结束后的状态与录制时一致，一致返回0
+int tetris_replay_verify(const TetrisReplay* r, const TetrisCore* c);
+
+#endif // TETRIS_REPLAY_H
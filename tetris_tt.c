@@ -0,0 +1,78 @@
+#include "tetris_tt.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline uint64_t tt_load(const TetrisTTWord* w) {
+#ifdef _MSC_VER
+    return (uint64_t)__iso_volatile_load64((const volatile long long*)w);
+#else
+    return atomic_load_explicit(w, memory_order_relaxed);
+#endif
+}
+
+static inline void tt_store(TetrisTTWord* w, uint64_t v) {
+#ifdef _MSC_VER
+    __iso_volatile_store64(w, (long long)v);
+#else
+    atomic_store_explicit(w, v, memory_order_relaxed);
+#endif
+}
+
+int tetris_tt_create(TetrisTT* tt, size_t bytes) {
+    memset(tt, 0, sizeof(*tt));
+    size_t n = 1;
+    if (bytes < sizeof(TetrisTTEntry)) return 0;
+    while (n * 2 * sizeof(TetrisTTEntry) <= bytes) n *= 2;
+    tt->entries = (TetrisTTEntry*)calloc(n, sizeof(TetrisTTEntry));
+    if (!tt->entries) return -1;
+    tt->mask = n - 1;
+    return 0;
+}
+
+void tetris_tt_destroy(TetrisTT* tt) {
+    free(tt->entries);
+    memset(tt, 0, sizeof(*tt));
+}
+
+void tetris_tt_clear(TetrisTT* tt) {
+    if (tt->entries) memset(tt->entries, 0, (tt->mask + 1) * sizeof(TetrisTTEntry));
+}
+
+int tetris_tt_probe(const TetrisTT* tt, uint64_t key, float* value) {
+    if (!tt->entries) return 0;
+    const TetrisTTEntry* e = &tt->entries[key & tt->mask];
+    uint64_t data = tt_load(&e->data);
+    uint64_t check = tt_load(&e->check);
+    // 全0的空项只可能匹配key=0
+    if ((check ^ data) != key || (check | data) == 0) return 0;
+    uint32_t bits = (uint32_t)data;
+    memcpy(value, &bits, sizeof(bits));
+    return 1;
+}
+
+void tetris_tt_store(TetrisTT* tt, uint64_t key, float value) {
+    if (!tt->entries) return;
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint64_t data = bits;
+    TetrisTTEntry* e = &tt->entries[key & tt->mask];
+    tt_store(&e->check, key ^ data);
+    tt_store(&e->data, data);
+}
+
+// splitmix64混合：序列中每个位置、每种方块得到独立的键
+static uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t tetris_tt_sequence_key(const TetrominoId* pieces, int n) {
+    // 长度也参与混合，保证“同一棋盘、不同剩余深度”的节点互不冲突
+    uint64_t k = mix64(0xC0FFEE00ULL + (uint64_t)n);
+    for (int i = 0; i < n; i++) k ^= mix64((uint64_t)(i * 8 + pieces[i] + 1) * 0x9E3779B97F4A7C15ULL);
+    return k;
+}
@@ -0,0 +1,46 @@
+#ifndef TETRIS_TT_H
+#define TETRIS_TT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "tetris_core.h"
+#ifndef _MSC_VER
+#include <stdatomic.h>
+#endif
+
+// 置换表：缓存搜索中已评估的棋盘（键为棋盘哈希与剩余方块序列的组合）
+// - 固定大小、直接映射、总是替换；多个搜索线程共享，跨方块保留
+// - 无锁：每项存 check = key ^ data 与 data 两个64位字，各自以relaxed原子读写，
+//   读出后校验 key == check ^ data，两个字来自不同写入（撕裂）的项校验失败，当作未命中
+// - 只缓存完整搜索得到的精确值，评估权重改变后需清空
+
+// 单个64位字（MSVC经__iso_volatile_load64/store64访问，等同relaxed原子操作）
+#ifdef _MSC_VER
+typedef volatile long long TetrisTTWord;
+#else
+typedef _Atomic uint64_t TetrisTTWord;
+#endif
+
+typedef struct {
+    TetrisTTWord check;   // key ^ data
+    TetrisTTWord data;    // 低32位为评估值（float位模式）
+} TetrisTTEntry;
+
+typedef struct {
+    TetrisTTEntry* entries;
+    size_t mask;      // 项数-1（项数为2的幂），entries为NULL时置换表关闭
+} TetrisTT;
+
+// 按字节数分配（向下取整到2的幂个项），bytes为0时关闭置换表；成功返回0
+int tetris_tt_create(TetrisTT* tt, size_t bytes);
+void tetris_tt_destroy(TetrisTT* tt);
+// 清空全部项
+void tetris_tt_clear(TetrisTT* tt);
+// 查找：命中时写入value并返回1
+int tetris_tt_probe(const TetrisTT* tt, uint64_t key, float* value);
+// 写入（覆盖同一槽位的旧项）
+void tetris_tt_store(TetrisTT* tt, uint64_t key, float value);
+// 剩余方块序列的键：与棋盘哈希异或得到搜索节点的键（n=0表示只评估棋盘）
+uint64_t tetris_tt_sequence_key(const TetrominoId* pieces, int n);
+
+#endif // TETRIS_TT_H
@@ -0,0 +1,400 @@
+#include "tetris_tune.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+#include "tetris_core.h"
+#include "tetris_movegen.h"
+
+// 一个个体：权重与本代适应度
+typedef struct {
+    TetrisWeights weights;
+    double fitness;
+} TuneIndividual;
+
+// 工作线程私有的对局资源（整个调参过程只分配一次）
+typedef struct {
+    TetrisCore core;
+    TetrisMoveGen gen;
+    TetrisPlacement placements[TETRIS_MAX_PLACEMENTS];
+    TetrisEvalBatch batch;
+} TuneSlot;
+
+// 一次调参的共享状态
+typedef struct {
+    const TetrisTuneConfig* cfg;
+    TuneIndividual* pop;
+    TuneIndividual* next_pop;
+    int* lines;            // [个体 * games + 局号]
+    int* scores;
+    uint32_t* pieces;
+    int* sorted;           // 统计分布用的临时数组（games个）
+    TuneSlot* slots;       // 每个线程一个
+    uint32_t game_seed;    // 本代对局种子的基础
+    SDL_atomic_t next;     // 下一个待执行的对局序号
+    SDL_atomic_t next_slot;
+    uint64_t rng;          // 遗传算子随机数（splitmix64）
+    int generation;
+} TuneState;
+
+void tetris_tune_default_config(TetrisTuneConfig* cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->population = 50;
+    cfg->games = 100;
+    cfg->max_pieces = 500;
+    cfg->generations = 20;
+    cfg->threads = 0;
+    cfg->seed = 1;
+    cfg->mutation_rate = 0.3f;
+    cfg->mutation_step = 0.2f;
+}
+
+static uint64_t next_random(TuneState* st) {
+    uint64_t z = (st->rng += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// [-1, 1)内的均匀随机数
+static float random_signed(TuneState* st) {
+    return (float)((double)(next_random(st) >> 11) * (1.0 / 4503599627370496.0) - 1.0);
+}
+
+// [0, n)内的随机整数
+static int random_index(TuneState* st, int n) {
+    return (int)((next_random(st) >> 32) * (uint64_t)n >> 32);
+}
+
+// 权重向量缩放为单位长度（评估为线性函数，整体缩放不改变落点选择）
+static void normalize(TetrisWeights* w) {
+    double sum = 0.0;
+    for (int i = 0; i < TETRIS_NUM_WEIGHTS; i++) sum += (double)w->w[i] * w->w[i];
+    if (sum <= 0.0) return;
+    float inv = (float)(1.0 / sqrt(sum));
+    for (int i = 0; i < TETRIS_NUM_WEIGHTS; i++) w->w[i] *= inv;
+}
+
+// 由基础种子、代数和局号派生对局种子（同一代的全部个体使用同一组对局）
+static uint32_t game_seed(uint32_t base, int game) {
+    uint32_t h = base ^ (0x9E3779B9u * (uint32_t)(game + 1));
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    return h;
+}
+
+// 一局贪心自我对弈
+// 功能点：
+// - 每个方块用落点生成器枚举全部落点，按批评估放置并消行后的棋盘，取消行奖励 + 评估值最大者
+// - 出生区域被占用的落点视为死局，全部落点都是死局时照常放置并由核心判定游戏结束
+// - 只使用线程私有的slot，不分配内存
+static void play_game(TuneSlot* slot, const TetrisWeights* w, uint32_t seed, int max_pieces,
+                      int* lines, int* score, uint32_t* pieces) {
+    TetrisCore* c = &slot->core;
+    uint16_t board[TETRIS_HEIGHT];
+    tetris_core_reset(c, seed);
+    while (!c->game_over && (int)c->pieces_placed < max_pieces) {
+        tetris_core_standard_rows(c, board);
+        int n = tetris_movegen_generate(&slot->gen, board, c->current_id, c->current_x, c->current_rot,
+                                        c->current_y, slot->placements, TETRIS_MAX_PLACEMENTS);
+        if (n == 0) break;
+        int best = 0;
+        float best_value = 0.0f;
+        for (int i = 0; i < n; i += TETRIS_EVAL_BATCH) {
+            int k = n - i < TETRIS_EVAL_BATCH ? n - i : TETRIS_EVAL_BATCH;
+            float reward[TETRIS_EVAL_BATCH], value[TETRIS_EVAL_BATCH];
+            uint8_t dead[TETRIS_EVAL_BATCH];
+            for (int j = 0; j < k; j++) {
+                uint16_t rows[TETRIS_HEIGHT];
+                memcpy(rows, board, sizeof(rows));
+                reward[j] = tetris_eval_clear_reward(tetris_movegen_apply(rows, NULL, c->current_id,
+                                                                          &slot->placements[i + j]), w);
+                dead[j] = (uint8_t)tetris_eval_spawn_blocked(rows);
+                tetris_eval_batch_set(&slot->batch, j, rows);
+            }
+            tetris_eval_batch(&slot->batch, k, w, value);
+            for (int j = 0; j < k; j++) {
+                float v = reward[j] + (dead[j] ? -1.0e9f : value[j]);
+                if ((i == 0 && j == 0) || v > best_value) {
+                    best = i + j;
+                    best_value = v;
+                }
+            }
+        }
+        const TetrisPlacement* p = &slot->placements[best];
+        if (tetris_core_place(c, p->rot, p->x, p->y) != 0) break;
+    }
+    *lines = c->lines_cleared;
+    *score = c->score;
+    *pieces = c->pieces_placed;
+}
+
+// 工作线程：领取一个线程私有的slot，然后不断领取对局直到本代全部完成
+static int tune_worker(void* data) {
+    TuneState* st = (TuneState*)data;
+    const TetrisTuneConfig* cfg = st->cfg;
+    TuneSlot* slot = &st->slots[SDL_AtomicAdd(&st->next_slot, 1)];
+    int total = cfg->population * cfg->games;
+    for (;;) {
+        int j = SDL_AtomicAdd(&st->next, 1);
+        if (j >= total) break;
+        int ind = j / cfg->games, game = j % cfg->games;
+        play_game(slot, &st->pop[ind].weights, game_seed(st->game_seed, game), cfg->max_pieces,
+                  &st->lines[j], &st->scores[j], &st->pieces[j]);
+    }
+    return 0;
+}
+
+// 并行运行一代的全部对局（线程每代新建，与chip8_corpus相同；线程数远小于对局数）
+static void run_generation(TuneState* st, int nthreads) {
+    SDL_AtomicSet(&st->next, 0);
+    SDL_AtomicSet(&st->next_slot, 0);
+    SDL_Thread* threads[256];
+    if (nthreads > 256) nthreads = 256;
+    for (int t = 1; t < nthreads; t++) threads[t] = SDL_CreateThread(tune_worker, "tetris-tune", st);
+    tune_worker(st);
+    for (int t = 1; t < nthreads; t++) {
+        if (threads[t]) SDL_WaitThread(threads[t], NULL);
+    }
+}
+
+static int compare_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// 适应度降序
+static int compare_fitness(const void* a, const void* b) {
+    double x = ((const TuneIndividual*)a)->fitness, y = ((const TuneIndividual*)b)->fitness;
+    return (x < y) - (x > y);
+}
+
+// 二元锦标赛：从前一半个体中随机取两个，保留较好者（种群已按适应度排序）
+static const TuneIndividual* tournament(TuneState* st) {
+    int half = st->cfg->population > 1 ? st->cfg->population / 2 : 1;
+    int a = random_index(st, half), b = random_index(st, half);
+    return &st->pop[a < b ? a : b];
+}
+
+// 产生下一代
+// 功能点：
+// - 前10%（至少1个）原样保留
+// - 其余由两个锦标赛胜者按适应度加权平均得到，再以mutation_rate概率对一个分量加扰动
+static void breed(TuneState* st) {
+    const TetrisTuneConfig* cfg = st->cfg;
+    int elite = cfg->population / 10 > 0 ? cfg->population / 10 : 1;
+    for (int i = 0; i < elite; i++) st->next_pop[i] = st->pop[i];
+    for (int i = elite; i < cfg->population; i++) {
+        const TuneIndividual* a = tournament(st);
+        const TuneIndividual* b = tournament(st);
+        double fa = a->fitness + 1.0, fb = b->fitness + 1.0;
+        TuneIndividual* child = &st->next_pop[i];
+        for (int k = 0; k < TETRIS_NUM_WEIGHTS; k++) {
+            child->weights.w[k] = (float)((a->weights.w[k] * fa + b->weights.w[k] * fb) / (fa + fb));
+        }
+        if ((float)(next_random(st) >> 40) * (1.0f / 16777216.0f) < cfg->mutation_rate) {
+            child->weights.w[random_index(st, TETRIS_NUM_WEIGHTS)] += cfg->mutation_step * random_signed(st);
+        }
+        normalize(&child->weights);
+        child->fitness = 0.0;
+    }
+    TuneIndividual* tmp = st->pop;
+    st->pop = st->next_pop;
+    st->next_pop = tmp;
+}
+
+// 写一行权重
+static void write_weights(FILE* f, const char* tag, double fitness, const TetrisWeights* w) {
+    fprintf(f, "%s %.4f", tag, fitness);
+    for (int k = 0; k < TETRIS_NUM_WEIGHTS; k++) fprintf(f, " %.9g", w->w[k]);
+    fprintf(f, "\n");
+}
+
+// 解析 "<适应度> w0 w1 ..."，分量数必须与TETRIS_NUM_WEIGHTS一致
+static int parse_weights(const char* s, double* fitness, TetrisWeights* w) {
+    char* end;
+    *fitness = strtod(s, &end);
+    if (end == s) return -1;
+    for (int k = 0; k < TETRIS_NUM_WEIGHTS; k++) {
+        s = end;
+        w->w[k] = (float)strtod(s, &end);
+        if (end == s) return -1;
+    }
+    return 0;
+}
+
+// 检查点：文本格式，每代整体覆盖
+//   generation <已完成代数>
+//   best <适应度> <权重...>
+//   ind <适应度> <权重...>   （每个个体一行）
+static int save_checkpoint(const char* path, const TuneState* st, const TuneIndividual* best) {
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+    fprintf(f, "# tetris tune checkpoint weights=%d population=%d\n", TETRIS_NUM_WEIGHTS, st->cfg->population);
+    fprintf(f, "generation %d\n", st->generation);
+    write_weights(f, "best", best->fitness, &best->weights);
+    for (int i = 0; i < st->cfg->population; i++) write_weights(f, "ind", st->pop[i].fitness, &st->pop[i].weights);
+    fclose(f);
+    return 0;
+}
+
+// 读取检查点：返回读到的个体数（-1表示文件不存在或格式不符）
+static int load_checkpoint(const char* path, TuneIndividual* pop, int max, int* generation, TuneIndividual* best) {
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+    char line[512];
+    int n = 0, have_best = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "generation ", 11) == 0) {
+            if (generation) *generation = atoi(line + 11);
+        } else if (strncmp(line, "best ", 5) == 0 && best) {
+            have_best = parse_weights(line + 5, &best->fitness, &best->weights) == 0;
+        } else if (strncmp(line, "ind ", 4) == 0 && pop && n < max) {
+            if (parse_weights(line + 4, &pop[n].fitness, &pop[n].weights) == 0) n++;
+        }
+    }
+    fclose(f);
+    if (best && !have_best) return -1;
+    return n;
+}
+
+int tetris_tune_load_best(const char* checkpoint, TetrisWeights* w) {
+    TuneIndividual best;
+    if (!checkpoint || load_checkpoint(checkpoint, NULL, 0, NULL, &best) < 0) return -1;
+    *w = best.weights;
+    return 0;
+}
+
+// 分布的第q个四分位点（q = 0..4，数组已排序）
+static int quartile(const int* v, int n, int q) {
+    return v[(int)((long long)(n - 1) * q / 4)];
+}
+
+// 调参主循环
+// 功能点：
+// - 初始种群：检查点中的个体；不足时以默认权重和随机方向补齐
+// - 每代：并行对局 → 计算适应度并排序 → 统计并写报告 → 保存检查点 → 繁殖下一代
+// - 对局数组、个体数组与线程私有资源只在开始时分配一次
+int tetris_tune_run(const TetrisTuneConfig* cfg, const char* checkpoint, FILE* report, TetrisWeights* best_out) {
+    if (!cfg || cfg->population < 2 || cfg->population > TETRIS_TUNE_MAX_POPULATION
+        || cfg->games < 1 || cfg->max_pieces < 1 || cfg->generations < 0) return -1;
+    TuneState st;
+    memset(&st, 0, sizeof(st));
+    st.cfg = cfg;
+    st.rng = cfg->seed;
+    int nthreads = cfg->threads > 0 ? cfg->threads : SDL_GetCPUCount();
+    if (nthreads < 1) nthreads = 1;
+    if (nthreads > 256) nthreads = 256;
+    size_t total = (size_t)cfg->population * (size_t)cfg->games;
+    st.pop = (TuneIndividual*)calloc((size_t)cfg->population, sizeof(TuneIndividual));
+    st.next_pop = (TuneIndividual*)calloc((size_t)cfg->population, sizeof(TuneIndividual));
+    st.lines = (int*)malloc(sizeof(int) * total);
+    st.scores = (int*)malloc(sizeof(int) * total);
+    st.pieces = (uint32_t*)malloc(sizeof(uint32_t) * total);
+    st.sorted = (int*)malloc(sizeof(int) * (size_t)cfg->games);
+    st.slots = (TuneSlot*)calloc((size_t)nthreads, sizeof(TuneSlot));
+    int rc = 0;
+    if (!st.pop || !st.next_pop || !st.lines || !st.scores || !st.pieces || !st.sorted || !st.slots) {
+        rc = -2;
+        goto done;
+    }
+    // 自我对弈在标准棋盘上进行
+    for (int i = 0; i < nthreads; i++) {
+        if (tetris_core_init(&st.slots[i].core, TETRIS_WIDTH, TETRIS_HEIGHT, 0) != 0) {
+            rc = -2;
+            goto done;
+        }
+    }
+
+    int loaded = checkpoint ? load_checkpoint(checkpoint, st.pop, cfg->population, &st.generation, NULL) : -1;
+    if (loaded < 0) {
+        loaded = 0;
+        st.generation = 0;
+    }
+    // 每次运行的随机数与对局都与已完成代数相关，继续运行不会重复前面的对局
+    st.rng ^= (uint64_t)st.generation * 0xD1B54A32D192ED03ULL;
+    for (int i = loaded; i < cfg->population; i++) {
+        if (i == 0) {
+            tetris_eval_default_weights(&st.pop[i].weights);
+        } else {
+            for (int k = 0; k < TETRIS_NUM_WEIGHTS; k++) st.pop[i].weights.w[k] = random_signed(&st);
+        }
+        normalize(&st.pop[i].weights);
+    }
+    // 检查点保存的是已评估并排序的一代，完整时直接繁殖下一代
+    if (loaded == cfg->population && st.generation > 0) breed(&st);
+
+    for (int g = 0; g < cfg->generations; g++) {
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        st.game_seed = game_seed(cfg->seed, st.generation + 1);
+        run_generation(&st, nthreads);
+
+        TetrisTuneReport r;
+        memset(&r, 0, sizeof(r));
+        r.generation = st.generation + 1;
+        for (int i = 0; i < cfg->population; i++) {
+            long long sum = 0;
+            for (int k = 0; k < cfg->games; k++) {
+                sum += st.lines[i * cfg->games + k];
+                r.pieces += st.pieces[i * cfg->games + k];
+            }
+            st.pop[i].fitness = (double)sum / cfg->games;
+            r.mean_fitness += st.pop[i].fitness / cfg->population;
+        }
+        // 排序前记下最优个体的对局结果
+        int top = 0;
+        for (int i = 1; i < cfg->population; i++) {
+            if (st.pop[i].fitness > st.pop[top].fitness) top = i;
+        }
+        long long score_sum = 0;
+        for (int k = 0; k < cfg->games; k++) {
+            st.sorted[k] = st.lines[top * cfg->games + k];
+            score_sum += st.scores[top * cfg->games + k];
+        }
+        qsort(st.sorted, (size_t)cfg->games, sizeof(int), compare_int);
+        qsort(st.pop, (size_t)cfg->population, sizeof(TuneIndividual), compare_fitness);
+        st.generation++;
+
+        r.best_fitness = st.pop[0].fitness;
+        r.lines_min = quartile(st.sorted, cfg->games, 0);
+        r.lines_p25 = quartile(st.sorted, cfg->games, 1);
+        r.lines_median = quartile(st.sorted, cfg->games, 2);
+        r.lines_p75 = quartile(st.sorted, cfg->games, 3);
+        r.lines_max = quartile(st.sorted, cfg->games, 4);
+        r.score_mean = (double)score_sum / cfg->games;
+        r.ms = (double)(SDL_GetPerformanceCounter() - t0) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+        if (report) {
+            fprintf(report, "第%d代：最优平均消行%.1f（最少%d/四分位%d/中位%d/四分位%d/最多%d，均分%.0f），"
+                    "种群平均%.1f，%.0f ms，%.0f块/秒\n",
+                    r.generation, r.best_fitness, r.lines_min, r.lines_p25, r.lines_median, r.lines_p75,
+                    r.lines_max, r.score_mean, r.mean_fitness, r.ms,
+                    r.ms > 0.0 ? (double)r.pieces * 1000.0 / r.ms : 0.0);
+            fflush(report);
+        }
+        if (checkpoint && save_checkpoint(checkpoint, &st, &st.pop[0]) != 0 && report) {
+            fprintf(report, "警告: 无法写入检查点 %s\n", checkpoint);
+        }
+        breed(&st);
+    }
+    // 繁殖时精英原样保留在最前，pop[0]即最近一代的最优个体
+    if (report) {
+        fprintf(report, "最优权重（平均消行%.1f）：", st.pop[0].fitness);
+        for (int k = 0; k < TETRIS_NUM_WEIGHTS; k++) fprintf(report, " %.6f", st.pop[0].weights.w[k]);
+        fprintf(report, "\n");
+    }
+    if (best_out) *best_out = st.pop[0].weights;
+
+done:
+    free(st.pop);
+    free(st.next_pop);
+    free(st.lines);
+    free(st.scores);
+    free(st.pieces);
+    free(st.sorted);
+    if (st.slots) {
+        for (int i = 0; i < nthreads; i++) tetris_core_free(&st.slots[i].core);
+    }
+    free(st.slots);
+    return rc;
+}
@@ -0,0 +1,52 @@
+#ifndef TETRIS_TUNE_H
+#define TETRIS_TUNE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "tetris_eval.h"
+
+// 自我对弈调参：用遗传算法优化机器人的评估权重
+// - 每代对每个个体用同一组种子进行games局无界面对局（贪心单层搜索，叶子批量评估）
+// - 对局按(个体, 局号)分给全部CPU核心，每个线程复用池中固定的TetrisCore与搜索缓冲，单局不分配内存
+// - 适应度为平均消行数；精英保留 + 锦标赛选择 + 按适应度加权交叉 + 单分量变异，权重向量保持单位长度
+// - 每代结束把种群写入检查点文件，再次运行时从检查点继续
+
+// 默认检查点文件（自动游玩会优先使用其中的最优权重）
+#define TETRIS_TUNE_DEFAULT_PATH "tetris_tune.txt"
+// 种群规模上限
+#define TETRIS_TUNE_MAX_POPULATION 1024
+
+typedef struct {
+    int population;        // 每代个体数
+    int games;             // 每个个体每代的对局数
+    int max_pieces;        // 每局最多放置的方块数（达到即结束，避免好权重永不结束）
+    int generations;       // 本次运行的代数（从检查点继续时追加）
+    int threads;           // 工作线程数（<=0表示使用全部CPU核心）
+    uint32_t seed;         // 对局种子与遗传算子随机数的基础种子
+    float mutation_rate;   // 子代发生变异的概率
+    float mutation_step;   // 变异幅度（单分量加上[-step, step]内的随机数）
+} TetrisTuneConfig;
+
+// 一代的统计
+typedef struct {
+    int generation;
+    double best_fitness;   // 最优个体的平均消行数
+    double mean_fitness;   // 种群平均
+    // 最优个体各局消行数的分布
+    int lines_min, lines_p25, lines_median, lines_p75, lines_max;
+    double score_mean;     // 最优个体的平均分数
+    uint64_t pieces;       // 本代放置的方块总数
+    double ms;             // 本代耗时
+} TetrisTuneReport;
+
+// 填充默认配置（50个体×100局×500块，20代）
+void tetris_tune_default_config(TetrisTuneConfig* cfg);
+
+// 运行调参：checkpoint为检查点文件（可为NULL，表示不保存），每代统计写入report（可为NULL）
+// 最优权重写入best（可为NULL）；返回0表示成功，负数表示参数或内存错误
+int tetris_tune_run(const TetrisTuneConfig* cfg, const char* checkpoint, FILE* report, TetrisWeights* best);
+
+// 从检查点读取最优权重，成功返回0
+int tetris_tune_load_best(const char* checkpoint, TetrisWeights* w);
+
+#endif // TETRIS_TUNE_H
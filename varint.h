@@ -0,0 +1,37 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 变长整数编码（LEB128，无符号）：每字节低7位为数据，最高位表示后续还有字节
+// 用于输入录制/回放等紧凑二进制格式，小数值只占1字节
+
+// 最大编码长度（32位值）
+#define VARINT_MAX_BYTES 5
+
+// 编码v到out（至少VARINT_MAX_BYTES字节空间），返回写入的字节数
+static inline int varint_write(uint8_t* out, uint32_t v) {
+    int n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+// 从[p, end)解码一个值到*v，返回消耗的字节数；数据截断或过长时返回0
+static inline int varint_read(const uint8_t* p, const uint8_t* end, uint32_t* v) {
+    uint32_t result = 0;
+    for (int n = 0; n < VARINT_MAX_BYTES && p + n < end; n++) {
+        result |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            *v = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+#endif // VARINT_H